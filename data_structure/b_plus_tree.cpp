@@ -1,5 +1,12 @@
 
+#include <algorithm>
 #include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "bloom_filter.hpp"
+#include "node_search.hpp"
 
 // B+树
 // Key：键类型，Value：值类型，M：阶数
@@ -50,6 +57,35 @@ public:
     // 查找
     std::pair<Iterator, bool> find(const KeyType& key) const;
 
+    bool contains(const KeyType& key) const { return find(key).second; }
+
+    // 第一个不小于key的位置
+    Iterator lowerBound(const KeyType& key) { return _lowerBound(key); }
+    ConstIterator lowerBound(const KeyType& key) const
+    {
+        Iterator it = _lowerBound(key);
+        return ConstIterator(it.node, it.pos);
+    }
+
+    // 按key升序访问[lo, hi]内的元素，fn(key, value)
+    template <class Fn>
+    void scan(const KeyType& lo, const KeyType& hi, Fn fn) const
+    {
+        scanBatch(lo, hi, [&fn](const KeyType* keys, const ValueType* values, int n)
+        {
+            for (int i = 0; i < n; ++i) fn(keys[i], values[i]);
+        });
+    }
+
+    // 批量访问[lo, hi]：每个叶子中落在区间内的连续部分调用一次fn(keys, values, n)。
+    // 处理当前叶子前预取后面第二个叶子（下一个叶子已在上一步预取）
+    template <class Fn>
+    void scanBatch(const KeyType& lo, const KeyType& hi, Fn fn) const;
+
+    // 按key降序访问[lo, hi]内的元素，沿prev指针后退，同样预取
+    template <class Fn>
+    void reverseScan(const KeyType& lo, const KeyType& hi, Fn fn) const;
+
     // 插入
     bool insert(const KeyType& key, const ValueType& value)
     { return _insert(key, value); }
@@ -69,7 +105,17 @@ public:
 
     Iterator erase(Iterator pos);
 
-    void clear() { if (root_) destroy(root_); }
+    // 由按key严格递增的(key, value)序列自底向上构建，原有数据被清空。
+    // 叶子按fillFactor填充并依次链接，再逐层建立索引节点；
+    // 每层的元素均分到各节点，保证每个节点不少于最小键数
+    template <class ForwardIt>
+    void bulkLoad(ForwardIt first, ForwardIt last, double fillFactor = 1.0);
+
+    void clear()
+    {
+        if (root_) destroy(root_);
+        root_ = nullptr;
+    }
 
     Iterator begin() { return minimum(); }
     ConstIterator begin() const { return minimum(); }
@@ -88,7 +134,50 @@ private:
     void mergeLeafNode(IndexNode* parent, int pos);
     void mergeIndexNode(IndexNode* parent, int pos);
 
+    // key所在的叶子节点
+    LeafNode* findLeaf(const KeyType& key) const
+    {
+        if (!root_) return nullptr;
+        NodeBase* cur = root_;
+        while (!cur->isLeaf())
+        {
+            cur = static_cast<IndexNode*>(cur)->childs[nodeUpperBound(cur->keys, cur->keyCount, key)];
+        }
+        return static_cast<LeafNode*>(cur);
+    }
+
+    Iterator _lowerBound(const KeyType& key) const
+    {
+        LeafNode* node = findLeaf(key);
+        if (!node) return nullptr;
+        int pos = nodeLowerBound(node->keys, node->keyCount, key);
+        return pos < node->keyCount ? Iterator(node, pos) : Iterator(node->next);
+    }
+
+    // 预取叶子节点的所有缓存行
+    static void prefetchLeaf(const LeafNode* node)
+    {
+        if (!node) return;
+        const char* p = reinterpret_cast<const char*>(node);
+        for (size_t i = 0; i < sizeof(LeafNode); i += 64) __builtin_prefetch(p + i);
+    }
+
     void destroy(NodeBase* node);
+
+    // n个元素按每组约per个（不超过maxPer）分组时的组数
+    static size_t groupCount(size_t n, int per, int maxPer)
+    {
+        size_t count = std::max(n / per, (n + maxPer - 1) / maxPer);
+        return count > 0 ? count : 1;
+    }
+
+    // 按填充率计算每个节点的元素数
+    static int fillCount(double fillFactor, int minCount, int maxCount)
+    {
+        int count = (int)(fillFactor * maxCount + 0.5);
+        count = std::min(std::max(count, minCount), maxCount);
+        return count > 0 ? count : 1;
+    }
     static NodeBase* clone(NodeBase* node, IndexNode* parent, LeafNode*& prev);
 
     LeafNode* minimum() const
@@ -121,7 +210,7 @@ private:
 
         const KeyType& key() const { return node->keys[pos]; }
         ValueRef operator*() const { return node->values[pos]; }
-        ValuePtr operator->() const { return &*this; }
+        ValuePtr operator->() const { return &**this; }
 
         Self& operator++()
         {
@@ -138,6 +227,23 @@ private:
             ++*this;
             return tmp;
         }
+
+        // 沿prev指针后退，第一个元素之前为end()
+        Self& operator--()
+        {
+            if (--pos < 0)
+            {
+                node = node->prev;
+                pos = node ? node->keyCount - 1 : 0;
+            }
+            return *this;
+        }
+        Self operator--(int)
+        {
+            Self tmp = *this;
+            --*this;
+            return tmp;
+        }
     };
 
     // 节点基类
@@ -166,6 +272,7 @@ private:
     {
         ValueType values[M];
         LeafNode* next;
+        LeafNode* prev = nullptr;
 
         LeafNode(): NodeBase(true) {}
     };
@@ -182,8 +289,7 @@ find(const KeyType& key) const -> std::pair<Iterator, bool>
     int pos = 0;
     while (cur)
     {
-        pos = 0;
-        while (pos < cur->keyCount && cur->keys[pos] <= key) ++pos;
+        pos = nodeUpperBound(cur->keys, cur->keyCount, key);
         if (!cur->isLeaf())
             cur = static_cast<IndexNode*>(cur)->childs[pos];
         else if (pos > 0 && key == cur->keys[pos - 1])
@@ -235,6 +341,8 @@ bool BPlusTree<Key, Value, M>::_insert(const KeyType& key, X&& value)
         }
         cur->keyCount -= brother->keyCount;
         brother->next = cur->next;
+        brother->prev = cur;
+        if (cur->next) cur->next->prev = brother;
         cur->next = brother;
 
         IndexNode* parent = cur->parent;
@@ -308,6 +416,7 @@ template <class Key, class Value, int M>
 auto BPlusTree<Key, Value, M>::erase(Iterator position) -> Iterator
 {
     Iterator next;
+    IndexNode* leafParent; // 合并后当前叶子可能已被释放，先记下父节点
     {
         LeafNode* cur = position.node;
         int pos = position.pos;
@@ -335,6 +444,7 @@ auto BPlusTree<Key, Value, M>::erase(Iterator position) -> Iterator
         }
 
         IndexNode* parent = cur->parent;
+        leafParent = parent;
         int childPos = 0; // 当前节点在parent的位置
         while (cur != parent->childs[childPos]) ++childPos;
 
@@ -390,7 +500,7 @@ auto BPlusTree<Key, Value, M>::erase(Iterator position) -> Iterator
         }
     }
 
-    IndexNode* cur = position.node->parent;
+    IndexNode* cur = leafParent;
 
     while (cur->keyCount < kMinKeyNum)
     {
@@ -488,6 +598,7 @@ void BPlusTree<Key, Value, M>::mergeLeafNode(IndexNode* parent, int pos)
     }
     left->keyCount += right->keyCount;
     left->next = right->next;
+    if (left->next) left->next->prev = left;
     delete right;
 }
 
@@ -521,6 +632,113 @@ void BPlusTree<Key, Value, M>::mergeIndexNode(IndexNode* parent, int pos)
 }
 
 
+template <class Key, class Value, int M>
+template <class ForwardIt>
+void BPlusTree<Key, Value, M>::bulkLoad(ForwardIt first, ForwardIt last, double fillFactor)
+{
+    clear();
+    size_t n = std::distance(first, last);
+    if (n == 0) return;
+
+    // 当前层的节点及其子树中的最小键
+    std::vector<std::pair<NodeBase*, KeyType>> level;
+
+    // 叶子层
+    int perLeaf = fillCount(fillFactor, kMinKeyNum, kMaxKeyNum);
+    size_t leafCount = groupCount(n, perLeaf, kMaxKeyNum);
+    level.reserve(leafCount);
+    LeafNode* prev = nullptr;
+    for (size_t i = 0; i < leafCount; ++i)
+    {
+        LeafNode* node = new LeafNode();
+        node->keyCount = n / leafCount + (i < n % leafCount);
+        for (int j = 0; j < node->keyCount; ++j, ++first)
+        {
+            node->keys[j] = (*first).first;
+            node->values[j] = (*first).second;
+        }
+        node->next = nullptr;
+        node->prev = prev;
+        if (prev) prev->next = node;
+        prev = node;
+        level.push_back({node, node->keys[0]});
+    }
+
+    // 逐层向上建立索引节点，每个节点有kMinKeyNum + 1到M个子节点
+    int perIndex = fillCount(fillFactor, kMinKeyNum + 1, M);
+    while (level.size() > 1)
+    {
+        size_t childCount = level.size();
+        size_t nodeCount = groupCount(childCount, perIndex, M);
+        std::vector<std::pair<NodeBase*, KeyType>> upper;
+        upper.reserve(nodeCount);
+        size_t pos = 0;
+        for (size_t i = 0; i < nodeCount; ++i)
+        {
+            IndexNode* node = new IndexNode();
+            int count = childCount / nodeCount + (i < childCount % nodeCount);
+            for (int j = 0; j < count; ++j)
+            {
+                node->childs[j] = level[pos + j].first;
+                node->childs[j]->parent = node;
+                if (j > 0) node->keys[j - 1] = level[pos + j].second;
+            }
+            node->keyCount = count - 1;
+            upper.push_back({node, level[pos].second});
+            pos += count;
+        }
+        level.swap(upper);
+    }
+    root_ = level[0].first;
+}
+
+
+template <class Key, class Value, int M>
+template <class Fn>
+void BPlusTree<Key, Value, M>::scanBatch(const KeyType& lo, const KeyType& hi, Fn fn) const
+{
+    if (hi < lo) return;
+    Iterator start = _lowerBound(lo);
+    const LeafNode* node = start.node;
+    int pos = start.pos;
+    if (node) prefetchLeaf(node->next);
+    while (node)
+    {
+        const LeafNode* next = node->next;
+        if (next) prefetchLeaf(next->next);
+        int end = nodeUpperBound(node->keys, node->keyCount, hi); // 第一个大于hi的位置
+        if (end > pos) fn(node->keys + pos, node->values + pos, end - pos);
+        if (end < node->keyCount) break;
+        node = next;
+        pos = 0;
+    }
+}
+
+
+template <class Key, class Value, int M>
+template <class Fn>
+void BPlusTree<Key, Value, M>::reverseScan(const KeyType& lo, const KeyType& hi, Fn fn) const
+{
+    if (hi < lo) return;
+    const LeafNode* node = findLeaf(hi);
+    if (!node) return;
+    int pos = nodeUpperBound(node->keys, node->keyCount, hi) - 1; // 最后一个不大于hi的位置
+    prefetchLeaf(node->prev);
+    while (node)
+    {
+        const LeafNode* prev = node->prev;
+        if (prev) prefetchLeaf(prev->prev);
+        for (; pos >= 0; --pos)
+        {
+            if (node->keys[pos] < lo) return;
+            fn(node->keys[pos], node->values[pos]);
+        }
+        node = prev;
+        if (node) pos = node->keyCount - 1;
+    }
+}
+
+
 template <class Key, class Value, int M>
 void BPlusTree<Key, Value, M>::destroy(NodeBase* cur)
 {
@@ -573,6 +791,7 @@ clone(NodeBase* node, IndexNode* parent, LeafNode*& prev) -> NodeBase*
             copy->values[i] = static_cast<LeafNode*>(node)->values[i];
         }
         copy->next = nullptr;
+        copy->prev = prev;
         if (prev) prev->next = copy;
         prev = copy;
         return copy;
@@ -581,6 +800,7 @@ clone(NodeBase* node, IndexNode* parent, LeafNode*& prev) -> NodeBase*
 
 
 // 测试
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
 #include <vector>
@@ -628,5 +848,59 @@ int main()
     for (const auto& x : tree2) cout << x << " ";
     cout << endl;
 
+    // 范围查询
+    BPlusTree<int, int, 4> range;
+    for (int i = 0; i < 30; ++i) range.insert(i * 3, i);
+    auto lb = range.lowerBound(10);
+    cout << lb.key() << " " << (--lb).key() << endl;
+    range.scan(10, 30, [](int key, int value) { cout << key << ":" << value << " "; });
+    cout << endl;
+    range.reverseScan(10, 30, [](int key, int) { cout << key << " "; });
+    cout << endl;
+    range.scanBatch(0, 89, [](const int* keys, const int*, int n)
+    {
+        cout << "[" << keys[0] << "," << keys[n - 1] << "] ";
+    });
+    cout << endl;
+
+    // 布隆过滤器前置过滤，未命中的查询大多不需要访问树
+    BloomFiltered<BPlusTree<int, int, 4>> filtered(1000);
+    for (int i = 0; i < 1000; ++i) filtered.insert(i * 2, i);
+    int hits = 0;
+    for (int i = 0; i < 2000; ++i) hits += filtered.contains(i);
+    cout << hits << " " << filtered.filteredCount() << endl;
+
+    // 有序数据逐个插入与批量构建的对比：耗时和叶子的平均填充率
+    using namespace std::chrono;
+    const int n = 1000000;
+    vector<pair<int, int>> sorted(n);
+    for (int i = 0; i < n; ++i) sorted[i] = {i, i};
+
+    auto leafFill = [](BPlusTree<int, int, 64>& t)
+    {
+        int leaves = 0, keys = 0;
+        for (auto it = t.begin(); it != t.end(); ++it)
+        {
+            if (it.pos == 0) ++leaves;
+            ++keys;
+        }
+        return (double)keys / leaves / 63;
+    };
+
+    BPlusTree<int, int, 64> inserted;
+    auto start = steady_clock::now();
+    for (const auto& x : sorted) inserted.insert(x.first, x.second);
+    double insertMs = duration<double, milli>(steady_clock::now() - start).count();
+
+    BPlusTree<int, int, 64> loaded;
+    start = steady_clock::now();
+    loaded.bulkLoad(sorted.begin(), sorted.end(), 0.9);
+    double loadMs = duration<double, milli>(steady_clock::now() - start).count();
+
+    cout << fixed << setprecision(2)
+         << "insert: " << insertMs << " ms, fill " << leafFill(inserted)
+         << "; bulkLoad: " << loadMs << " ms, fill " << leafFill(loaded)
+         << "; " << loaded.contains(n / 2) << loaded.contains(n) << endl;
+
     return 0;
 }
\ No newline at end of file
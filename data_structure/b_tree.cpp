@@ -3,6 +3,8 @@
 #include <queue>
 #include <iostream>
 
+#include "node_search.hpp"
+
 // B树
 template <class Key, class Value, int M>
 class BTree
@@ -78,6 +80,10 @@ private:
     static const KeyType& getKey(const Object& obj)
     { return obj.first; }
 
+    // 节点内第一个不小于key的位置，键与值交替存放，用无分支二分查找
+    static int searchNode(const Node* node, const KeyType& key)
+    { return nodeLowerBound(node->objects, node->keyCount, key, getKey); }
+
     static constexpr int kMinKeyNum = (M + 1) / 2 - 1;
     static constexpr int kMaxKeyNum = M - 1;
 
@@ -99,16 +105,8 @@ auto BTree<Key, Value, M>::find(const KeyType& key) const -> std::pair<Node*, in
     Node* cur = root_;
     while (cur)
     {
-        int pos = 0;
-        while (pos < cur->keyCount)
-        {
-            if (key < getKey(cur->objects[pos]))
-                break;
-            else if (getKey(cur->objects[pos]) < key)
-                ++pos;
-            else
-                return {cur, pos};
-        }
+        int pos = searchNode(cur, key);
+        if (pos < cur->keyCount && !(key < getKey(cur->objects[pos]))) return {cur, pos};
         cur = cur->childs[pos];
     }
     return {nullptr, -1};
@@ -126,16 +124,8 @@ bool BTree<Key, Value, M>::_insert(X&& obj)
     int pos;
     while (cur)
     {
-        pos = 0;
-        while (pos < cur->keyCount)
-        {
-            if (key < getKey(cur->objects[pos]))
-                break;
-            else if (getKey(cur->objects[pos]) < key)
-                ++pos;
-            else
-                return false;
-        }
+        pos = searchNode(cur, key);
+        if (pos < cur->keyCount && !(key < getKey(cur->objects[pos]))) return false;
         parent = cur;
         cur = cur->childs[pos];
     }
@@ -0,0 +1,67 @@
+#include "hash_table.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+// 对比逐个find与findBatch、逐个insert与insertBatch
+int main()
+{
+    using namespace std;
+    using namespace std::chrono;
+    const int n = 4000000;
+    const int lookups = 4000000;
+
+    mt19937 rng(7);
+    vector<int> keys(n);
+    for (auto& x : keys) x = rng();
+
+    HashTable<int> table;
+    auto start = steady_clock::now();
+    for (int x : keys) table.insert(x);
+    double insertSec = duration<double>(steady_clock::now() - start).count();
+
+    HashTable<int> batchTable;
+    start = steady_clock::now();
+    for (int base = 0; base < n; base += 256)
+    {
+        batchTable.insertBatch(&keys[base], min(256, n - base));
+    }
+    double insertBatchSec = duration<double>(steady_clock::now() - start).count();
+
+    cout << fixed << setprecision(2);
+    cout << "insert      " << setw(8) << n / insertSec / 1e6 << " Mops/s" << endl;
+    cout << "insertBatch " << setw(8) << n / insertBatchSec / 1e6 << " Mops/s" << endl;
+
+    // 一半命中、一半未命中
+    vector<int> probes(lookups);
+    for (int i = 0; i < lookups; ++i)
+    {
+        probes[i] = (i & 1) ? keys[rng() % n] : (int)rng();
+    }
+
+    long hits = 0;
+    start = steady_clock::now();
+    for (int x : probes) hits += table.find(x) != table.end();
+    double findSec = duration<double>(steady_clock::now() - start).count();
+    cout << "find        " << setw(8) << lookups / findSec / 1e6 << " Mops/s"
+         << "  hits " << hits << endl;
+
+    for (int batch : {32, 64, 128, 256})
+    {
+        vector<HashTable<int>::Iterator> out(batch);
+        hits = 0;
+        start = steady_clock::now();
+        for (int base = 0; base + batch <= lookups; base += batch)
+        {
+            table.findBatch(&probes[base], batch, out.data());
+            for (const auto& it : out) hits += it != table.end();
+        }
+        double sec = duration<double>(steady_clock::now() - start).count();
+        cout << "findBatch/" << setw(3) << left << batch << right << setw(7)
+             << lookups / sec / 1e6 << " Mops/s  hits " << hits << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "hash_table.hpp"
+#include "node_pool.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+// 构造哈希表，重复3次取最短耗时，减少页错误和堆状态的影响
+template <class Table, class Build>
+void measure(const std::string& name, Build build)
+{
+    using namespace std::chrono;
+    double best = 1e100;
+    int size = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        auto start = steady_clock::now();
+        Table table = build();
+        best = std::min(best, duration<double, std::milli>(steady_clock::now() - start).count());
+        size = table.size();
+    }
+    std::cout << std::left << std::setw(36) << name << std::right
+              << std::setw(10) << size
+              << std::setw(12) << std::fixed << std::setprecision(1) << best << std::endl;
+}
+
+
+int main()
+{
+    using namespace std;
+    const int n = 1 << 22;
+    vector<long> keys(n);
+    mt19937_64 rng(42);
+    for (auto& x : keys) x = rng();
+
+    using Plain = HashTable<long>;
+    using Pooled = HashTable<long, hash<long>, std::_Identity<long>, NodePool<long>>;
+
+    cout << left << setw(36) << "build" << right << setw(10) << "size"
+         << setw(12) << "ms" << endl;
+
+    measure<Plain>("insert loop", [&]
+    {
+        Plain t;
+        for (long x : keys) t.insert(x);
+        return t;
+    });
+    measure<Plain>("insertRange", [&] { return Plain(keys.begin(), keys.end()); });
+    measure<Pooled>("insertRange + NodePool", [&] { return Pooled(keys.begin(), keys.end()); });
+    for (int threads = 2; threads <= 8; threads *= 2)
+    {
+        measure<Pooled>("insertRange + NodePool, " + to_string(threads) + " threads",
+                        [&] { return Pooled(keys.begin(), keys.end(), threads); });
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "hash_table.hpp"
+#include "linked_hash_table.hpp"
+#include "rb_tree.hpp"
+#include "node_pool.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// 统计全局堆分配次数
+static long gAllocCount = 0;
+
+void* operator new(std::size_t size)
+{
+    ++gAllocCount;
+    void* p = ::malloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { ::free(p); }
+void operator delete(void* p, std::size_t) noexcept { ::free(p); }
+
+
+// 插入n个元素后反复删除/插入，最后clear
+template <class Container>
+void churn(const std::string& name, const std::vector<int>& keys, int rounds)
+{
+    using namespace std::chrono;
+    long allocBefore = gAllocCount;
+    auto start = steady_clock::now();
+
+    Container c;
+    long ops = 0;
+    for (int r = 0; r < rounds; ++r)
+    {
+        for (int x : keys) c.insert(x);
+        for (int i = 0; i < (int)keys.size(); i += 2) c.remove(keys[i]);
+        for (int i = 0; i < (int)keys.size(); i += 2) c.insert(keys[i]);
+        c.clear();
+        ops += keys.size() * 2;
+    }
+
+    double sec = duration<double>(steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(32) << name
+              << std::right << std::setw(12) << gAllocCount - allocBefore
+              << std::setw(14) << std::fixed << std::setprecision(2)
+              << ops / sec / 1e6 << std::endl;
+}
+
+
+int main()
+{
+    using namespace std;
+    const int n = 200000;
+    const int rounds = 10;
+
+    vector<int> keys(n);
+    mt19937 rng(42);
+    for (auto& x : keys) x = rng();
+
+    cout << left << setw(32) << "container" << right << setw(12) << "allocs"
+         << setw(14) << "Mops/s" << endl;
+
+    using Identity = std::_Identity<int>;
+    churn<HashTable<int>>("HashTable", keys, rounds);
+    churn<HashTable<int, hash<int>, Identity, NodePool<int>>>("HashTable+NodePool", keys, rounds);
+
+    churn<LinkedHashTable<int>>("LinkedHashTable", keys, rounds);
+    churn<LinkedHashTable<int, hash<int>, Identity, NodePool<int>>>("LinkedHashTable+NodePool", keys, rounds);
+
+    churn<RBTree<int>>("RBTree", keys, rounds);
+    churn<RBTree<int, int, Identity, less<int>, NodePool<int>>>("RBTree+NodePool", keys, rounds);
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "node_search.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// 节点内查找的耗时对比：原有的线性扫描、无分支二分查找、nodeUpperBound（SIMD）
+// 模拟B+树的一层：若干已满（M - 1个键）的节点，每次查找随机选一个节点。
+// 节点总大小为32KB时数据在缓存中，比较的是计算开销；为32MB时每次查找都有缓存未命中
+
+template <class Key>
+int linearScan(const Key* keys, int n, Key key)
+{
+    int pos = 0;
+    while (pos < n && keys[pos] <= key) ++pos;
+    return pos;
+}
+
+template <class Key>
+int branchless(const Key* keys, int n, Key key)
+{ return node_search::branchlessSearch(keys, n, [key](Key x) { return !(key < x); }); }
+
+template <class Key>
+int simd(const Key* keys, int n, Key key)
+{ return nodeUpperBound(keys, n, key); }
+
+
+template <class Key, int M>
+void benchM(const char* typeName, size_t bytes)
+{
+    using namespace std::chrono;
+    const int kNodes = bytes / (M * sizeof(Key));
+    const int kQueries = 1 << 22;
+    const int n = M - 1;
+
+    std::mt19937 rng(M);
+    std::vector<Key> keys((size_t)kNodes * M);
+    for (int i = 0; i < kNodes; ++i)
+    {
+        Key* node = &keys[(size_t)i * M];
+        for (int j = 0; j < n; ++j) node[j] = (Key)(rng() % 100000);
+        std::sort(node, node + n);
+    }
+    std::vector<std::pair<int, Key>> queries(kQueries);
+    for (auto& q : queries) q = {(int)(rng() % kNodes), (Key)(rng() % 100000)};
+
+    auto run = [&](int (*search)(const Key*, int, Key), long& checksum)
+    {
+        auto start = steady_clock::now();
+        long sum = 0;
+        for (const auto& q : queries) sum += search(&keys[(size_t)q.first * M], n, q.second);
+        checksum = sum;
+        return duration<double, std::nano>(steady_clock::now() - start).count() / kQueries;
+    };
+
+    long c1, c2, c3;
+    double linearNs = run(linearScan<Key>, c1);
+    double branchlessNs = run(branchless<Key>, c2);
+    double simdNs = run(simd<Key>, c3);
+
+    std::cout << std::setw(7) << typeName << std::setw(6) << M
+              << std::setw(8) << (bytes >> 10) << "K"
+              << std::setw(12) << linearNs << std::setw(12) << branchlessNs
+              << std::setw(12) << simdNs
+              << (c1 == c2 && c2 == c3 ? "" : "  mismatch!") << std::endl;
+}
+
+
+template <class Key>
+void sweep(const char* typeName)
+{
+    for (size_t bytes : {(size_t)32 << 10, (size_t)32 << 20})
+    {
+        benchM<Key, 16>(typeName, bytes);
+        benchM<Key, 32>(typeName, bytes);
+        benchM<Key, 64>(typeName, bytes);
+        benchM<Key, 128>(typeName, bytes);
+        benchM<Key, 256>(typeName, bytes);
+    }
+}
+
+
+int main()
+{
+#ifdef __AVX2__
+    std::cout << "SIMD: AVX2" << std::endl;
+#else
+    std::cout << "SIMD: none (compile with -mavx2)" << std::endl;
+#endif
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "   type     M    data  linear(ns)  binary(ns)    simd(ns)" << std::endl;
+    sweep<int32_t>("int32");
+    sweep<int64_t>("int64");
+    sweep<float>("float");
+    sweep<double>("double");
+    return 0;
+}
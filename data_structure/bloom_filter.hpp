@@ -0,0 +1,275 @@
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// 分块布隆过滤器（split block）
+// 每个key只落在一个256位的块中，块内8个32位字各置1位，位下标由key的哈希值与8个奇数盐值相乘得到。
+// 查询只访问一个缓存行，8个字的位测试相互独立，定义__AVX2__时用一条256位指令完成
+template <class Key, class HashFunc = std::hash<Key>>
+class BloomFilter
+{
+public:
+    // expectedKeys：预计的元素个数，fpRate：期望的误判率
+    BloomFilter(size_t expectedKeys, double fpRate = 0.01)
+        : blocks_(nullptr), blockCount_(blocksFor(expectedKeys, fpRate)),
+          expectedKeys_(expectedKeys), fpRate_(fpRate), size_(0)
+    { allocate(); }
+
+    // 按每个key占用的位数构造，误判率由位数决定，targetFpRate()返回对应的理论误判率
+    static BloomFilter withBitsPerKey(size_t expectedKeys, double bitsPerKey)
+    {
+        size_t blocks = (size_t)std::ceil(expectedKeys * bitsPerKey / (kBlockBytes * 8));
+        if (blocks == 0) blocks = 1;
+        return BloomFilter(expectedKeys, blocks,
+                           falsePositiveRate((double)expectedKeys / blocks));
+    }
+
+    ~BloomFilter() { ::free(blocks_); }
+
+    // 拷贝构造函数
+    BloomFilter(const BloomFilter& rhs)
+        : blocks_(nullptr), blockCount_(rhs.blockCount_),
+          expectedKeys_(rhs.expectedKeys_), fpRate_(rhs.fpRate_), size_(rhs.size_)
+    {
+        allocate();
+        std::memcpy(blocks_, rhs.blocks_, blockCount_ * sizeof(Block));
+    }
+
+    // 移动构造函数，rhs变为只有一个块的空过滤器，仍可插入和查询
+    BloomFilter(BloomFilter&& rhs): BloomFilter(0)
+    { swap(rhs); }
+
+    BloomFilter& operator=(BloomFilter rhs) noexcept
+    {
+        swap(rhs);
+        return *this;
+    }
+
+    void swap(BloomFilter& rhs) noexcept
+    {
+        using std::swap;
+        swap(blocks_, rhs.blocks_);
+        swap(blockCount_, rhs.blockCount_);
+        swap(expectedKeys_, rhs.expectedKeys_);
+        swap(fpRate_, rhs.fpRate_);
+        swap(size_, rhs.size_);
+    }
+
+    void insert(const Key& key)
+    {
+        uint64_t h = mix(HashFunc()(key));
+        Block& block = blocks_[blockOf(h)];
+#ifdef __AVX2__
+        __m256i* p = reinterpret_cast<__m256i*>(block.words);
+        _mm256_store_si256(p, _mm256_or_si256(_mm256_load_si256(p), masks(h)));
+#else
+        uint32_t m[kWords];
+        masks(h, m);
+        for (int i = 0; i < kWords; ++i) block.words[i] |= m[i];
+#endif
+        ++size_;
+    }
+
+    // 返回false时key一定不存在，返回true时key可能存在
+    bool mayContain(const Key& key) const
+    {
+        uint64_t h = mix(HashFunc()(key));
+        const Block& block = blocks_[blockOf(h)];
+#ifdef __AVX2__
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(block.words));
+        return _mm256_testc_si256(v, masks(h));
+#else
+        uint32_t m[kWords];
+        masks(h, m);
+        uint32_t miss = 0;
+        for (int i = 0; i < kWords; ++i) miss |= m[i] & ~block.words[i];
+        return miss == 0;
+#endif
+    }
+
+    void clear()
+    {
+        std::memset(blocks_, 0, blockCount_ * sizeof(Block));
+        size_ = 0;
+    }
+
+    // 已插入的次数（重复插入重复计数）
+    size_t size() const { return size_; }
+    size_t blockCount() const { return blockCount_; }
+    size_t memoryBytes() const { return blockCount_ * sizeof(Block); }
+
+    // 构造时的参数
+    size_t expectedKeys() const { return expectedKeys_; }
+    double targetFpRate() const { return fpRate_; }
+
+    // 每个key占用的位数（按预计元素个数）
+    double bitsPerKey() const
+    { return expectedKeys_ ? 8.0 * memoryBytes() / expectedKeys_ : 0; }
+
+    // 按当前元素个数估计的误判率
+    double estimatedFpRate() const
+    { return blockCount_ ? falsePositiveRate((double)size_ / blockCount_) : 0; }
+
+    // 平均每块有keysPerBlock个key时的误判率：块内key数服从泊松分布，
+    // 块内有j个key时，8个字中对应位全为1的概率为(1 - (31/32)^j)^8
+    static double falsePositiveRate(double keysPerBlock)
+    {
+        double lambda = keysPerBlock;
+        int maxJ = (int)(lambda + 10 * std::sqrt(lambda) + 20);
+        double p = std::exp(-lambda); // 泊松概率P(j)
+        double rate = 0;
+        for (int j = 0; j <= maxJ; ++j)
+        {
+            if (j > 0) p *= lambda / j;
+            rate += p * std::pow(1 - std::pow(1 - 1.0 / kBitsPerWord, j), kWords);
+        }
+        return rate;
+    }
+
+private:
+    static constexpr int kWords = 8; // 每块的字数
+    static constexpr int kBitsPerWord = 32;
+    static constexpr int kBlockBytes = kWords * kBitsPerWord / 8;
+
+    struct Block
+    {
+        uint32_t words[kWords];
+    };
+
+    BloomFilter(size_t expectedKeys, size_t blockCount, double fpRate)
+        : blocks_(nullptr), blockCount_(blockCount),
+          expectedKeys_(expectedKeys), fpRate_(fpRate), size_(0)
+    { allocate(); }
+
+    // 二分查找满足误判率的最大平均每块key数，得到块数
+    static size_t blocksFor(size_t expectedKeys, double fpRate)
+    {
+        double lo = 0.01, hi = 256;
+        for (int i = 0; i < 50; ++i)
+        {
+            double mid = (lo + hi) / 2;
+            if (falsePositiveRate(mid) <= fpRate)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        size_t blocks = (size_t)std::ceil(expectedKeys / lo);
+        return blocks > 0 ? blocks : 1;
+    }
+
+    void allocate()
+    {
+        void* p = nullptr;
+        if (::posix_memalign(&p, kBlockBytes, blockCount_ * sizeof(Block)) != 0)
+            throw std::bad_alloc();
+        blocks_ = static_cast<Block*>(p);
+        std::memset(blocks_, 0, blockCount_ * sizeof(Block));
+    }
+
+    // 哈希值再混合一次，避免std::hash对整数是恒等映射
+    static uint64_t mix(uint64_t h)
+    {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // 高32位选择块
+    size_t blockOf(uint64_t h) const
+    { return (size_t)(((h >> 32) * blockCount_) >> 32); }
+
+#ifdef __AVX2__
+    static __m256i masks(uint64_t h)
+    {
+        const __m256i salts = _mm256_setr_epi32(
+            0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d,
+            0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31);
+        __m256i prod = _mm256_mullo_epi32(_mm256_set1_epi32((uint32_t)h), salts);
+        return _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_srli_epi32(prod, 27));
+    }
+#else
+    // 低32位与各盐值相乘，取高5位作为字内的位下标
+    static void masks(uint64_t h, uint32_t* m)
+    {
+        static const uint32_t salts[kWords] = {
+            0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d,
+            0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31};
+        uint32_t k = (uint32_t)h;
+        for (int i = 0; i < kWords; ++i) m[i] = 1u << ((k * salts[i]) >> 27);
+    }
+#endif
+
+    Block* blocks_;
+    size_t blockCount_;
+    size_t expectedKeys_;
+    double fpRate_;
+    size_t size_;
+};
+
+
+// 以布隆过滤器为前置过滤的容器
+// insert的第一个参数作为key记入过滤器；contains先查过滤器，过滤器判断不存在时不访问容器。
+// 布隆过滤器不支持删除，remove后该key的位仍保留，删除较多时应重建
+template <class Container, class HashFunc = std::hash<typename std::decay<typename Container::KeyType>::type>>
+class BloomFiltered
+{
+public:
+    using Key = typename std::decay<typename Container::KeyType>::type;
+
+    BloomFiltered(size_t expectedKeys, double fpRate = 0.01)
+        : filter_(expectedKeys, fpRate), filtered_(0) {}
+
+    // 使用构造好的过滤器，如BloomFilter::withBitsPerKey
+    explicit BloomFiltered(BloomFilter<Key, HashFunc> filter)
+        : filter_(std::move(filter)), filtered_(0) {}
+
+    template <class... Args>
+    auto insert(const Key& key, Args&&... args)
+        -> decltype(std::declval<Container&>().insert(key, std::forward<Args>(args)...))
+    {
+        filter_.insert(key);
+        return container_.insert(key, std::forward<Args>(args)...);
+    }
+
+    bool contains(const Key& key) const
+    {
+        if (!filter_.mayContain(key))
+        {
+            ++filtered_;
+            return false;
+        }
+        return container_.contains(key);
+    }
+
+    bool remove(const Key& key) { return container_.remove(key); }
+
+    // 被过滤器直接拒绝的查询次数
+    long filteredCount() const { return filtered_; }
+
+    const BloomFilter<Key, HashFunc>& filter() const { return filter_; }
+    Container& container() { return container_; }
+    const Container& container() const { return container_; }
+
+private:
+    Container container_;
+    BloomFilter<Key, HashFunc> filter_;
+    mutable long filtered_;
+};
+
+
+#endif // BLOOM_FILTER_HPP
@@ -0,0 +1,322 @@
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "linked_hash_table.hpp"
+
+using PageId = uint32_t;
+
+
+// 按固定大小的页读写的文件，页号从0开始
+// 读写出错时抛出std::runtime_error，树的操作进行到一半时无法返回错误码
+class PageFile
+{
+public:
+    PageFile(): fd_(-1), pageSize_(0), pageCount_(0) {}
+    ~PageFile() { close(); }
+
+    PageFile(const PageFile&) = delete;
+    PageFile& operator=(const PageFile&) = delete;
+
+    // 打开文件，不存在时创建；truncate为true时清空原有内容
+    bool open(const std::string& path, int pageSize, bool truncate = false)
+    {
+        close();
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+        if (fd_ < 0) return false;
+        struct stat st;
+        if (::fstat(fd_, &st) != 0 || st.st_size % pageSize != 0)
+        {
+            close();
+            return false;
+        }
+        pageSize_ = pageSize;
+        pageCount_ = st.st_size / pageSize;
+        return true;
+    }
+
+    void close()
+    {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        pageCount_ = 0;
+    }
+
+    bool isOpen() const { return fd_ >= 0; }
+
+    // 分配新页，写入时文件才增长
+    PageId allocate() { return pageCount_++; }
+
+    // 读取一页，文件末尾之后的部分填0
+    void read(PageId id, void* buf)
+    {
+        ssize_t n = ::pread(fd_, buf, pageSize_, (off_t)id * pageSize_);
+        if (n < 0) throw std::runtime_error("PageFile: read failed");
+        if (n < pageSize_) std::memset((char*)buf + n, 0, pageSize_ - n);
+    }
+
+    void write(PageId id, const void* buf)
+    {
+        if (::pwrite(fd_, buf, pageSize_, (off_t)id * pageSize_) != pageSize_)
+            throw std::runtime_error("PageFile: write failed");
+    }
+
+    void sync() { ::fsync(fd_); }
+
+    int pageSize() const { return pageSize_; }
+    PageId pageCount() const { return pageCount_; }
+
+private:
+    int fd_;
+    int pageSize_;
+    PageId pageCount_;
+};
+
+
+class BufferPool;
+
+// 固定（pin）住的页，析构时解除固定；拷贝时再固定一次
+class PageHandle
+{
+public:
+    PageHandle(): pool_(nullptr), frame_(-1), id_(0), data_(nullptr) {}
+    ~PageHandle() { release(); }
+
+    PageHandle(const PageHandle& rhs);
+    PageHandle(PageHandle&& rhs) noexcept
+        : pool_(rhs.pool_), frame_(rhs.frame_), id_(rhs.id_), data_(rhs.data_)
+    { rhs.pool_ = nullptr; }
+
+    PageHandle& operator=(PageHandle rhs) noexcept
+    {
+        std::swap(pool_, rhs.pool_);
+        std::swap(frame_, rhs.frame_);
+        std::swap(id_, rhs.id_);
+        std::swap(data_, rhs.data_);
+        return *this;
+    }
+
+    // 解除固定
+    void release();
+
+    // 标记为已修改，淘汰或flush时写回文件
+    void markDirty();
+
+    explicit operator bool() const { return pool_ != nullptr; }
+
+    PageId id() const { return id_; }
+    char* data() const { return data_; }
+
+private:
+    friend class BufferPool;
+
+    PageHandle(BufferPool* pool, int frame, PageId id, char* data)
+        : pool_(pool), frame_(frame), id_(id), data_(data) {}
+
+    BufferPool* pool_;
+    int frame_;
+    PageId id_;
+    char* data_;
+};
+
+
+// LRU缓冲池
+// 页表是LinkedHashTable（页号 -> 帧号），命中时移到链表末尾；
+// 需要空闲帧时从链表头部找第一个未被固定的帧淘汰，已修改的页先写回文件。
+// 被固定的页不会被淘汰，所有帧都被固定时抛出std::runtime_error。不是线程安全的
+class BufferPool
+{
+public:
+    struct Stats
+    {
+        long hits = 0;
+        long misses = 0;
+        long evictions = 0;
+        long writeBacks = 0; // 写回文件的页数（淘汰和flush）
+
+        double hitRatio() const
+        { return hits + misses == 0 ? 0 : (double)hits / (hits + misses); }
+    };
+
+    // capacity：缓存的页数
+    BufferPool(PageFile& file, int capacity)
+        : file_(file), pageSize_(file.pageSize()), frames_(capacity), table_(capacity)
+    {
+        void* p = nullptr;
+        if (::posix_memalign(&p, 4096, (size_t)capacity * pageSize_) != 0)
+            throw std::bad_alloc();
+        buffer_ = static_cast<char*>(p);
+        for (int i = capacity - 1; i >= 0; --i) freeFrames_.push_back(i);
+    }
+
+    // 析构前应调用flush写回已修改的页
+    ~BufferPool() { ::free(buffer_); }
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // 固定一页，不在缓冲池中时从文件读入
+    PageHandle fetch(PageId id)
+    {
+        int frame = pin(id);
+        return PageHandle(this, frame, id, frameData(frame));
+    }
+
+    // 分配并固定一个全0的新页
+    PageHandle newPage()
+    {
+        int frame = victim();
+        PageId id = file_.allocate();
+        std::memset(frameData(frame), 0, pageSize_);
+        frames_[frame] = {id, 1, true};
+        table_.insert({id, frame});
+        return PageHandle(this, frame, id, frameData(frame));
+    }
+
+    // 不使用PageHandle时手动固定/解除固定
+    char* pinPage(PageId id) { return frameData(pin(id)); }
+
+    void unpinPage(PageId id, bool dirty)
+    {
+        auto it = table_.find(id);
+        if (it != table_.end()) unpin(it->second, dirty);
+    }
+
+    // 写回所有已修改的页
+    void flush()
+    {
+        for (int i = 0; i < (int)frames_.size(); ++i)
+        {
+            if (frames_[i].dirty) writeBack(i);
+        }
+        file_.sync();
+    }
+
+    int capacity() const { return frames_.size(); }
+    int pageSize() const { return pageSize_; }
+
+    // 当前被固定的页数
+    int pinnedCount() const
+    {
+        int count = 0;
+        for (const auto& frame : frames_) count += frame.pinCount > 0;
+        return count;
+    }
+
+    Stats stats() const { return stats_; }
+    void resetStats() { stats_ = Stats(); }
+
+private:
+    friend class PageHandle;
+
+    template <class Pair>
+    struct select1st
+    {
+        const typename Pair::first_type& operator()(const Pair& pair) const
+        { return pair.first; }
+    };
+
+    using Object = std::pair<const PageId, int>;
+    using PageTable = LinkedHashTable<Object, std::hash<PageId>, select1st<Object>>;
+
+    struct Frame
+    {
+        PageId id = 0;
+        int pinCount = 0;
+        bool dirty = false;
+    };
+
+    char* frameData(int frame) const { return buffer_ + (size_t)frame * pageSize_; }
+
+    int pin(PageId id)
+    {
+        auto it = table_.find(id);
+        if (it != table_.end())
+        {
+            ++stats_.hits;
+            table_.moveToLast(it);
+            ++frames_[it->second].pinCount;
+            return it->second;
+        }
+        ++stats_.misses;
+        int frame = victim();
+        file_.read(id, frameData(frame));
+        frames_[frame] = {id, 1, false};
+        table_.insert({id, frame});
+        return frame;
+    }
+
+    void unpin(int frame, bool dirty)
+    {
+        --frames_[frame].pinCount;
+        if (dirty) frames_[frame].dirty = true;
+    }
+
+    // 取得一个空闲帧，没有时淘汰最久未使用且未被固定的页
+    int victim()
+    {
+        if (!freeFrames_.empty())
+        {
+            int frame = freeFrames_.back();
+            freeFrames_.pop_back();
+            return frame;
+        }
+        for (auto it = table_.begin(); it != table_.end(); ++it)
+        {
+            int frame = it->second;
+            if (frames_[frame].pinCount > 0) continue;
+            if (frames_[frame].dirty) writeBack(frame);
+            table_.erase(it);
+            ++stats_.evictions;
+            return frame;
+        }
+        throw std::runtime_error("BufferPool: all frames are pinned");
+    }
+
+    void writeBack(int frame)
+    {
+        file_.write(frames_[frame].id, frameData(frame));
+        frames_[frame].dirty = false;
+        ++stats_.writeBacks;
+    }
+
+    PageFile& file_;
+    int pageSize_;
+    char* buffer_;
+    std::vector<Frame> frames_;
+    std::vector<int> freeFrames_;
+    PageTable table_;
+    Stats stats_;
+};
+
+
+inline PageHandle::PageHandle(const PageHandle& rhs)
+    : pool_(rhs.pool_), frame_(rhs.frame_), id_(rhs.id_), data_(rhs.data_)
+{
+    if (pool_) ++pool_->frames_[frame_].pinCount;
+}
+
+inline void PageHandle::release()
+{
+    if (pool_) pool_->unpin(frame_, false);
+    pool_ = nullptr;
+}
+
+inline void PageHandle::markDirty()
+{
+    pool_->frames_[frame_].dirty = true;
+}
+
+#endif // BUFFER_POOL_HPP
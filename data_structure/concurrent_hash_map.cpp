@@ -0,0 +1,290 @@
+#include "hash_table.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+// 分段加锁的并发哈希map
+// key空间按哈希值划分到多个分段，每个分段是一个独立的HashTable，由各自的读写锁保护
+template <class Key, class Value, class HashFunc = std::hash<Key>>
+class ConcurrentHashMap
+{
+public:
+    template <class Pair>
+    struct select1st
+    {
+        const typename Pair::first_type& operator()(const Pair& pair) const
+        { return pair.first; }
+    };
+
+    using Object = std::pair<const Key, Value>;
+    using MHashTable = HashTable<Object, HashFunc, select1st<Object>>;
+    using KeyType = typename MHashTable::KeyType;
+
+    // shardCount取整为2的幂次方，n为每个分段的初始桶数
+    ConcurrentHashMap(int shardCount = 64, int n = 32)
+        : shardBits_(log2(roundupPowerOfTwo(shardCount))),
+          shards_(1 << shardBits_)
+    {
+        for (auto& shard : shards_) shard.table = MHashTable(n);
+    }
+
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+    // 插入（不重复）
+    bool insert(const Object& obj)
+    {
+        Shard& shard = shardOf(obj.first);
+        std::lock_guard<std::shared_timed_mutex> lock(shard.mutex);
+        return shard.table.insert(obj).second;
+    }
+
+    bool insert(Object&& obj)
+    {
+        Shard& shard = shardOf(obj.first);
+        std::lock_guard<std::shared_timed_mutex> lock(shard.mutex);
+        return shard.table.insert(std::move(obj)).second;
+    }
+
+    // 查找，找到时将value拷贝到输出参数
+    bool find(const KeyType& key, Value& value) const
+    { return visit(key, [&value](const Value& v) { value = v; }); }
+
+    // 查找，找到时在读锁保护下调用fn(const Value&)
+    template <class Visitor>
+    bool visit(const KeyType& key, Visitor&& fn) const
+    {
+        const Shard& shard = shardOf(key);
+        std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+        auto it = shard.table.find(key);
+        if (it == shard.table.end()) return false;
+        fn(it->second);
+        return true;
+    }
+
+    bool contains(const KeyType& key) const
+    { return visit(key, [](const Value&) {}); }
+
+    // 不存在key时由make()生成value并插入，返回value的拷贝；make()在写锁内调用，只会执行一次
+    template <class Factory>
+    Value computeIfAbsent(const KeyType& key, Factory&& make)
+    {
+        Shard& shard = shardOf(key);
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+            auto it = shard.table.find(key);
+            if (it != shard.table.end()) return it->second;
+        }
+        std::lock_guard<std::shared_timed_mutex> lock(shard.mutex);
+        auto it = shard.table.find(key);
+        if (it == shard.table.end()) it = shard.table.insert({key, make()}).first;
+        return it->second;
+    }
+
+    // 删除
+    bool remove(const KeyType& key)
+    {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::shared_timed_mutex> lock(shard.mutex);
+        return shard.table.remove(key);
+    }
+
+    // 并行遍历所有元素，每个线程负责若干分段，fn(const Object&)需可并发调用
+    template <class Func>
+    void forEach(Func fn, int threadCount = std::thread::hardware_concurrency()) const
+    {
+        threadCount = std::max(1, std::min(threadCount, (int)shards_.size()));
+        auto work = [this, &fn, threadCount](int id)
+        {
+            for (int i = id; i < (int)shards_.size(); i += threadCount)
+            {
+                std::shared_lock<std::shared_timed_mutex> lock(shards_[i].mutex);
+                for (const auto& x : shards_[i].table) fn(x);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int i = 1; i < threadCount; ++i) threads.emplace_back(work, i);
+        work(0);
+        for (auto& t : threads) t.join();
+    }
+
+    void clear()
+    {
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::shared_timed_mutex> lock(shard.mutex);
+            shard.table.clear();
+        }
+    }
+
+    // 各分段分别加锁统计，并发修改时结果只是近似值
+    int size() const
+    {
+        int count = 0;
+        for (const auto& shard : shards_)
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+            count += shard.table.size();
+        }
+        return count;
+    }
+
+    int shardCount() const { return shards_.size(); }
+
+private:
+    // 分段之间填充一个缓存行，避免不同分段的锁之间伪共享
+    struct Shard
+    {
+        mutable std::shared_timed_mutex mutex;
+        MHashTable table;
+        char padding[64];
+    };
+
+    // 用乘法哈希的高位选择分段，与分段内HashTable使用的低位相互独立
+    int shardPos(const KeyType& key) const
+    {
+        if (shardBits_ == 0) return 0;
+        uint64_t h = static_cast<uint64_t>(HashFunc()(key)) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<int>(h >> (64 - shardBits_));
+    }
+
+    Shard& shardOf(const KeyType& key) { return shards_[shardPos(key)]; }
+    const Shard& shardOf(const KeyType& key) const { return shards_[shardPos(key)]; }
+
+    static int log2(unsigned int n)
+    {
+        int bits = 0;
+        while ((1u << bits) < n) ++bits;
+        return bits;
+    }
+
+    // 取整为2的幂次方
+    static unsigned int roundupPowerOfTwo(unsigned int i)
+    {
+        --i;
+        i |= i >> 1;
+        i |= i >> 2;
+        i |= i >> 4;
+        i |= i >> 8;
+        i |= i >> 16;
+        return i + 1;
+    }
+
+    int shardBits_;
+    std::vector<Shard> shards_;
+};
+
+
+// 测试
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+
+// 对比单个全局锁保护的HashTable
+template <class Key, class Value>
+class GlobalLockMap
+{
+public:
+    bool insert(const std::pair<const Key, Value>& obj)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return table_.insert(obj).second;
+    }
+
+    bool find(const Key& key, Value& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = table_.find(key);
+        if (it == table_.end()) return false;
+        value = it->second;
+        return true;
+    }
+
+private:
+    template <class Pair>
+    struct select1st
+    {
+        const typename Pair::first_type& operator()(const Pair& pair) const
+        { return pair.first; }
+    };
+
+    std::mutex mutex_;
+    HashTable<std::pair<const Key, Value>, std::hash<Key>, select1st<std::pair<const Key, Value>>> table_;
+};
+
+
+// 90%查找、10%插入的混合负载，返回吞吐量（百万次操作/秒）
+template <class Map>
+double throughput(Map& map, int threadCount, int opsPerThread, int keyRange)
+{
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t]
+        {
+            std::mt19937 rng(t);
+            while (!go.load()) std::this_thread::yield();
+            long value = 0;
+            for (int i = 0; i < opsPerThread; ++i)
+            {
+                int key = rng() % keyRange;
+                if (i % 10 == 0)
+                    map.insert({key, (long)i});
+                else
+                    map.find(key, value);
+            }
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& t : threads) t.join();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (double)threadCount * opsPerThread / sec / 1e6;
+}
+
+
+int main()
+{
+    using namespace std;
+    ConcurrentHashMap<int, long> map;
+    map.insert({298, 153});
+    map.insert({190, 123});
+    map.insert({892, 132});
+    map.remove(190);
+
+    long value = 0;
+    cout << map.size() << endl;
+    cout << map.find(298, value) << " " << value << endl;
+    cout << map.find(190, value) << endl;
+    cout << map.computeIfAbsent(92, [] { return 456L; }) << endl;
+    cout << map.computeIfAbsent(92, [] { return 789L; }) << endl;
+
+    atomic<long> sum(0);
+    map.forEach([&sum](const pair<const int, long>& x) { sum += x.second; }, 4);
+    cout << sum << endl;
+
+    map.clear();
+    cout << map.size() << " " << map.find(298, value) << " " << map.remove(298) << endl;
+
+    const int opsPerThread = 200000;
+    const int keyRange = 1 << 20;
+    cout << setw(8) << "threads" << setw(14) << "sharded" << setw(14) << "global lock"
+         << "   (Mops/s)" << endl;
+    cout << fixed << setprecision(2);
+    for (int threads = 1; threads <= 64; threads *= 2)
+    {
+        ConcurrentHashMap<int, long> sharded;
+        GlobalLockMap<int, long> global;
+        double a = throughput(sharded, threads, opsPerThread, keyRange);
+        double b = throughput(global, threads, opsPerThread, keyRange);
+        cout << setw(8) << threads << setw(14) << a << setw(14) << b << endl;
+    }
+    return 0;
+}
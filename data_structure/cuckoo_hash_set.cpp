@@ -0,0 +1,476 @@
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 布谷鸟哈希集合
+// 每个元素只可能在两个桶之一，每个桶4个槽位和1字节的占用位图，按缓存行对齐。
+// sizeof(Object) <= 15时一个桶是一个缓存行，find最多访问两个缓存行；
+// 更大的元素每个桶占多个缓存行（如16字节的元素，位图在第65字节，桶大小为128字节）。
+// 插入时两个桶都满则随机踢出一个元素到它的另一个桶，踢出次数超过上限时扩容。
+// 要求HashFunc分布均匀，大量key哈希值相同时无论怎样扩容都放不下
+template <class Object, class HashFunc = std::hash<Object>>
+class CuckooHashSet
+{
+    struct Bucket;
+    template <class BucketPtr> struct IteratorT;
+public:
+    using Iterator = IteratorT<Bucket*>;
+    using ConstIterator = IteratorT<const Bucket*>;
+    using KeyType = const Object&;
+
+    CuckooHashSet(int n = 32)
+        : buckets_(nullptr), bucketCount_(0), bucketBits_(0), size_(0), rng_(0x2545F4914F6CDD1DULL)
+    { allocate(bucketsFor(n)); }
+
+    ~CuckooHashSet() { destroy(); }
+
+    // 拷贝构造函数
+    CuckooHashSet(const CuckooHashSet& rhs): CuckooHashSet(rhs.size_)
+    {
+        for (const auto& x : rhs) insert(x);
+    }
+
+    // 移动构造函数，rhs变为没有桶的空表，下次插入时再分配
+    CuckooHashSet(CuckooHashSet&& rhs) noexcept
+        : buckets_(nullptr), bucketCount_(0), bucketBits_(0), size_(0), rng_(rhs.rng_)
+    { swap(rhs); }
+
+    CuckooHashSet& operator=(CuckooHashSet rhs) noexcept
+    {
+        swap(rhs);
+        return *this;
+    }
+
+    void swap(CuckooHashSet& rhs) noexcept
+    {
+        using std::swap;
+        swap(buckets_, rhs.buckets_);
+        swap(bucketCount_, rhs.bucketCount_);
+        swap(size_, rhs.size_);
+        swap(bucketBits_, rhs.bucketBits_);
+        swap(rng_, rhs.rng_);
+    }
+
+    // 插入（不重复），插入可能移动其他元素，之前的迭代器失效
+    std::pair<Iterator, bool> insert(const Object& obj)
+    { return _insert(Object(obj)); }
+
+    std::pair<Iterator, bool> insert(Object&& obj)
+    { return _insert(std::move(obj)); }
+
+    // 查找：只检查两个桶
+    ConstIterator find(const KeyType& key) const
+    {
+        if (size_ == 0) return end();
+        size_t h = HashFunc()(key);
+        int b1 = bucket1(h);
+        int slot = buckets_[b1].find(key);
+        if (slot >= 0) return ConstIterator(buckets_ + b1, slot, this);
+        int b2 = bucket2(h, b1);
+        slot = buckets_[b2].find(key);
+        if (slot >= 0) return ConstIterator(buckets_ + b2, slot, this);
+        return end();
+    }
+
+    Iterator find(const KeyType& key)
+    {
+        ConstIterator it = static_cast<const CuckooHashSet*>(this)->find(key);
+        return Iterator(const_cast<Bucket*>(it.bucket), it.slot, this);
+    }
+
+    // 删除
+    bool remove(const KeyType& key)
+    {
+        Iterator it = find(key);
+        if (it == end()) return false;
+        it.bucket->erase(it.slot);
+        --size_;
+        return true;
+    }
+
+    void clear()
+    {
+        for (int i = 0; i < bucketCount_; ++i) buckets_[i].clear();
+        size_ = 0;
+    }
+
+    int size() const { return size_; }
+    int bucketCount() const { return bucketCount_; }
+    double loadFactor() const { return bucketCount_ ? (double)size_ / (bucketCount_ * kSlots) : 0; }
+
+    ConstIterator begin() const { return ConstIterator(buckets_, -1, this).next(); }
+    Iterator begin() { return Iterator(buckets_, -1, this).next(); }
+
+    ConstIterator end() const { return ConstIterator(buckets_ + bucketCount_, 0, this); }
+    Iterator end() { return Iterator(buckets_ + bucketCount_, 0, this); }
+
+private:
+    static constexpr int kSlots = 4; // 每个桶的槽位数
+    static constexpr int kMaxKicks = 500; // 一次插入最多踢出的次数
+    static constexpr int kCacheLine = 64;
+
+    // 大小为kSlots * sizeof(Object) + 1按64字节向上取整
+    struct alignas(kCacheLine) Bucket
+    {
+        typename std::aligned_storage<sizeof(Object), alignof(Object)>::type slots[kSlots];
+        unsigned char used; // 第i位表示第i个槽位有元素
+
+        Object& at(int i) { return *reinterpret_cast<Object*>(&slots[i]); }
+        const Object& at(int i) const { return *reinterpret_cast<const Object*>(&slots[i]); }
+
+        bool full() const { return used == (1 << kSlots) - 1; }
+
+        int find(const Object& key) const
+        {
+            for (int i = 0; i < kSlots; ++i)
+            {
+                if ((used >> i & 1) && at(i) == key) return i;
+            }
+            return -1;
+        }
+
+        // 放入空槽位，返回槽位下标
+        int put(Object&& obj)
+        {
+            int i = 0;
+            while (used >> i & 1) ++i;
+            new (&slots[i]) Object(std::move(obj));
+            used |= 1 << i;
+            return i;
+        }
+
+        void erase(int i)
+        {
+            at(i).~Object();
+            used &= ~(1 << i);
+        }
+
+        void clear()
+        {
+            for (int i = 0; i < kSlots; ++i)
+            {
+                if (used >> i & 1) erase(i);
+            }
+        }
+    };
+
+    // 迭代器
+    template <class BucketPtr>
+    struct IteratorT
+    {
+        BucketPtr bucket;
+        int slot;
+        const CuckooHashSet* set;
+
+        using Self = IteratorT;
+
+        IteratorT() {}
+        IteratorT(BucketPtr _bucket, int _slot, const CuckooHashSet* _set)
+            : bucket(_bucket), slot(_slot), set(_set) {}
+
+        bool operator==(const Self& it) const { return bucket == it.bucket && slot == it.slot; }
+        bool operator!=(const Self& it) const { return !(*this == it); }
+
+        const Object& operator*() const { return bucket->at(slot); }
+        const Object* operator->() const { return &bucket->at(slot); }
+
+        // 移到下一个有元素的槽位
+        Self& next()
+        {
+            BucketPtr last = set->buckets_ + set->bucketCount_;
+            while (bucket != last)
+            {
+                while (++slot < kSlots)
+                {
+                    if (bucket->used >> slot & 1) return *this;
+                }
+                ++bucket;
+                slot = -1;
+            }
+            slot = 0;
+            return *this;
+        }
+
+        Self& operator++() { return next(); }
+        Self operator++(int)
+        {
+            Self tmp = *this;
+            next();
+            return tmp;
+        }
+    };
+
+    // 两个桶由哈希值经过不同的混合得到，取高位
+    int bucket1(size_t h) const
+    { return (uint64_t(h) * 0x9E3779B97F4A7C15ULL) >> (64 - bucketBits_); }
+
+    int bucket2(size_t h, int b1) const
+    {
+        int b2 = ((uint64_t(h) ^ 0x5851F42D4C957F2DULL) * 0xC2B2AE3D27D4EB4FULL) >> (64 - bucketBits_);
+        return b2 != b1 ? b2 : b1 ^ 1;
+    }
+
+    // 元素在b之外的另一个桶
+    int otherBucket(const Object& obj, int b) const
+    {
+        size_t h = HashFunc()(obj);
+        int b1 = bucket1(h);
+        return b1 != b ? b1 : bucket2(h, b1);
+    }
+
+    std::pair<Iterator, bool> _insert(Object&& obj);
+
+    // 从桶b开始随机游走踢出元素，失败时obj为最后被踢出、无处安放的元素
+    bool place(Object& obj, int b);
+
+    // 放入新元素：先试两个桶的空槽位，都满时踢出
+    bool placeNew(Object& obj);
+
+    // 扩容并重新放入所有元素，extra非空时一并放入
+    void rehash(int newBucketCount, Object* extra = nullptr);
+
+    // 把所有元素移到objs中并释放桶
+    void takeAll(std::vector<Object>& objs);
+
+    // 分配count个桶并放入objs中的元素，失败时元素全部移回objs
+    bool placeAll(std::vector<Object>& objs, int count);
+
+    uint64_t nextRandom()
+    {
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 7;
+        rng_ ^= rng_ << 17;
+        return rng_;
+    }
+
+    // 按最大装载率约90%计算桶数，至少2个桶，为2的幂次方
+    static int bucketsFor(int n)
+    {
+        int count = 2;
+        while (count * kSlots * 9 / 10 < n) count <<= 1;
+        return count;
+    }
+
+    void allocate(int count)
+    {
+        void* p = nullptr;
+        if (::posix_memalign(&p, kCacheLine, sizeof(Bucket) * count) != 0) throw std::bad_alloc();
+        buckets_ = static_cast<Bucket*>(p);
+        for (int i = 0; i < count; ++i) buckets_[i].used = 0;
+        bucketCount_ = count;
+        bucketBits_ = 0;
+        while ((1 << bucketBits_) < count) ++bucketBits_;
+    }
+
+    void destroy()
+    {
+        if (!buckets_) return;
+        clear();
+        ::free(buckets_);
+        buckets_ = nullptr;
+        bucketCount_ = 0;
+    }
+
+    Bucket* buckets_;
+    int bucketCount_;
+    int bucketBits_;
+    int size_;
+    uint64_t rng_;
+};
+
+
+template <class Object, class HashFunc>
+constexpr int CuckooHashSet<Object, HashFunc>::kSlots;
+
+template <class Object, class HashFunc>
+constexpr int CuckooHashSet<Object, HashFunc>::kMaxKicks;
+
+
+template <class Object, class HashFunc>
+auto CuckooHashSet<Object, HashFunc>::_insert(Object&& obj) -> std::pair<Iterator, bool>
+{
+    if (bucketCount_ == 0) allocate(bucketsFor(0)); // 被移动后的空表
+    Iterator it = find(obj);
+    if (it != end()) return {it, false};
+
+    if (size_ + 1 > bucketCount_ * kSlots * 9 / 10) rehash(bucketCount_ * 2);
+    ++size_;
+
+    size_t h = HashFunc()(obj);
+    int b1 = bucket1(h);
+    if (!buckets_[b1].full())
+        return {Iterator(buckets_ + b1, buckets_[b1].put(std::move(obj)), this), true};
+    int b2 = bucket2(h, b1);
+    if (!buckets_[b2].full())
+        return {Iterator(buckets_ + b2, buckets_[b2].put(std::move(obj)), this), true};
+
+    // 踢出过程中新元素可能再次被移动，最后按key查找其位置
+    Object key(obj);
+    if (!place(obj, nextRandom() & 1 ? b1 : b2)) rehash(bucketCount_ * 2, &obj);
+    return {find(key), true};
+}
+
+
+template <class Object, class HashFunc>
+bool CuckooHashSet<Object, HashFunc>::place(Object& obj, int b)
+{
+    for (int kick = 0; kick < kMaxKicks; ++kick)
+    {
+        Bucket& bucket = buckets_[b];
+        if (!bucket.full())
+        {
+            bucket.put(std::move(obj));
+            return true;
+        }
+        // 与随机一个槽位的元素交换，被踢出的元素去它的另一个桶
+        int slot = nextRandom() % kSlots;
+        std::swap(obj, bucket.at(slot));
+        b = otherBucket(obj, b);
+    }
+    return false;
+}
+
+
+template <class Object, class HashFunc>
+bool CuckooHashSet<Object, HashFunc>::placeNew(Object& obj)
+{
+    size_t h = HashFunc()(obj);
+    int b1 = bucket1(h);
+    if (!buckets_[b1].full())
+    {
+        buckets_[b1].put(std::move(obj));
+        return true;
+    }
+    int b2 = bucket2(h, b1);
+    if (!buckets_[b2].full())
+    {
+        buckets_[b2].put(std::move(obj));
+        return true;
+    }
+    return place(obj, nextRandom() & 1 ? b1 : b2);
+}
+
+
+template <class Object, class HashFunc>
+void CuckooHashSet<Object, HashFunc>::rehash(int newBucketCount, Object* extra)
+{
+    std::vector<Object> objs;
+    objs.reserve(size_);
+    takeAll(objs);
+    if (extra) objs.push_back(std::move(*extra));
+    while (!placeAll(objs, newBucketCount)) newBucketCount *= 2;
+}
+
+
+template <class Object, class HashFunc>
+void CuckooHashSet<Object, HashFunc>::takeAll(std::vector<Object>& objs)
+{
+    for (int i = 0; i < bucketCount_; ++i)
+    {
+        for (int s = 0; s < kSlots; ++s)
+        {
+            if (!(buckets_[i].used >> s & 1)) continue;
+            objs.push_back(std::move(buckets_[i].at(s)));
+            buckets_[i].erase(s);
+        }
+    }
+    ::free(buckets_);
+    buckets_ = nullptr;
+    bucketCount_ = 0;
+}
+
+
+template <class Object, class HashFunc>
+bool CuckooHashSet<Object, HashFunc>::placeAll(std::vector<Object>& objs, int count)
+{
+    allocate(count);
+    for (size_t i = 0; i < objs.size(); ++i)
+    {
+        if (!placeNew(objs[i]))
+        {
+            // objs[i]现在是无处安放的元素，已放入的元素连同剩余元素全部取回
+            std::vector<Object> rest;
+            rest.reserve(objs.size());
+            takeAll(rest);
+            for (size_t j = i; j < objs.size(); ++j) rest.push_back(std::move(objs[j]));
+            objs.swap(rest);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// 测试
+#include "hash_table.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+
+// 逐次计时查找，输出延迟分位数（纳秒），一半命中一半未命中
+template <class Set>
+void latency(const std::string& name, const Set& set, const std::vector<long>& queries)
+{
+    using namespace std::chrono;
+    std::vector<long> ns(queries.size());
+    long found = 0;
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        auto start = steady_clock::now();
+        found += set.find(queries[i]) != set.end();
+        ns[i] = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    }
+    std::sort(ns.begin(), ns.end());
+    auto pct = [&ns](double p) { return ns[std::min(ns.size() - 1, (size_t)(p * ns.size()))]; };
+    std::cout << std::left << std::setw(12) << name << std::right
+              << std::setw(8) << pct(0.5) << std::setw(8) << pct(0.99)
+              << std::setw(8) << pct(0.999) << std::setw(10) << ns.back()
+              << std::setw(10) << found << std::endl;
+}
+
+
+int main()
+{
+    using namespace std;
+    CuckooHashSet<int> set(4);
+    for (int i = 0; i < 1000; ++i) set.insert(i * 3);
+    for (int i = 0; i < 1000; i += 2) set.remove(i * 3);
+    cout << set.size() << " " << (set.find(3) != set.end()) << " "
+         << (set.find(6) != set.end()) << endl;
+
+    int count = 0;
+    for (int x : set) count += x % 3 == 0;
+    cout << count << " " << set.loadFactor() << endl;
+
+    // 被移动后仍可使用
+    CuckooHashSet<int> moved = std::move(set);
+    set.insert(1);
+    cout << moved.size() << " " << set.size() << " " << (set.find(1) != set.end()) << endl;
+
+    // 尾延迟对比
+    const int n = 1 << 20;
+    vector<long> keys(n), queries;
+    mt19937_64 rng(7);
+    for (auto& x : keys) x = rng();
+    for (int i = 0; i < n; ++i) queries.push_back(i % 2 ? keys[rng() % n] : (long)rng());
+
+    CuckooHashSet<long> cuckoo;
+    HashTable<long> chained;
+    for (long x : keys)
+    {
+        cuckoo.insert(x);
+        chained.insert(x);
+    }
+    cout << left << setw(12) << "find (ns)" << right << setw(8) << "p50" << setw(8) << "p99"
+         << setw(8) << "p99.9" << setw(10) << "max" << setw(10) << "found" << endl;
+    latency("cuckoo", cuckoo, queries);
+    latency("chained", chained, queries);
+    return 0;
+}
@@ -0,0 +1,680 @@
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "buffer_pool.hpp"
+#include "node_search.hpp"
+
+// 存储在文件中的B+树
+// 索引节点和叶子节点都是PageSize大小的页，以页号相互引用，经LRU缓冲池读写，数据量可远大于内存。
+// 第0页是元数据页（根节点、空闲页链表），合并后释放的页链入空闲页链表，分配时优先复用。
+// 页内没有父指针（分裂索引节点时不必改写被移动的子节点），查找时用栈记录从根到叶子的路径，
+// 栈中的页保持固定，分裂、借键、合并沿栈向上处理。
+// Key和Value必须可平凡拷贝；不是线程安全的
+template <class Key, class Value, int PageSize = 4096>
+class DiskBPlusTree
+{
+    static_assert(std::is_trivially_copyable<Key>::value, "Key must be trivially copyable");
+    static_assert(std::is_trivially_copyable<Value>::value, "Value must be trivially copyable");
+
+    struct LeafNode;
+public:
+    using KeyType = Key;
+    using ValueType = Value;
+
+    class ConstIterator;
+
+    DiskBPlusTree(): root_(kNoPage), freeHead_(kNoPage), size_(0) {}
+    ~DiskBPlusTree() { close(); }
+
+    DiskBPlusTree(const DiskBPlusTree&) = delete;
+    DiskBPlusTree& operator=(const DiskBPlusTree&) = delete;
+
+    // 打开或创建索引文件，poolPages为缓冲池的页数；文件格式不匹配时返回false
+    bool open(const std::string& path, int poolPages, bool truncate = false);
+
+    // 写回所有修改并关闭文件
+    void close()
+    {
+        if (!pool_) return;
+        flush();
+        pool_.reset();
+        file_.close();
+    }
+
+    // 写回元数据和所有已修改的页
+    void flush();
+
+    // 查找，找到时将值写入value
+    bool find(const KeyType& key, ValueType& value);
+
+    bool contains(const KeyType& key)
+    {
+        ValueType value;
+        return find(key, value);
+    }
+
+    // 插入，key已存在时返回false
+    bool insert(const KeyType& key, const ValueType& value);
+
+    // 删除
+    bool remove(const KeyType& key);
+
+    size_t size() const { return size_; }
+
+    // 文件中的页数（包括元数据页和空闲页）
+    PageId pageCount() const { return file_.pageCount(); }
+
+    BufferPool::Stats poolStats() const { return pool_->stats(); }
+    void resetPoolStats() { pool_->resetStats(); }
+
+    // 沿叶子链表顺序遍历，迭代器固定当前叶子页
+    ConstIterator begin();
+    ConstIterator end() { return ConstIterator(); }
+
+    class ConstIterator
+    {
+    public:
+        ConstIterator(): pool_(nullptr), pos_(0) {}
+
+        bool operator==(const ConstIterator& it) const
+        { return page_.data() == it.page_.data() && pos_ == it.pos_; }
+        bool operator!=(const ConstIterator& it) const { return !(*this == it); }
+
+        const KeyType& key() const { return leaf()->keys[pos_]; }
+        const ValueType& operator*() const { return leaf()->values[pos_]; }
+        const ValueType* operator->() const { return &leaf()->values[pos_]; }
+
+        ConstIterator& operator++()
+        {
+            if (++pos_ >= leaf()->keyCount)
+            {
+                PageId next = leaf()->next;
+                page_ = next == kNoPage ? PageHandle() : pool_->fetch(next);
+                pos_ = 0;
+            }
+            return *this;
+        }
+
+        ConstIterator operator++(int)
+        {
+            ConstIterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+    private:
+        friend class DiskBPlusTree;
+
+        ConstIterator(BufferPool* pool, PageHandle page)
+            : pool_(pool), page_(std::move(page)), pos_(0) {}
+
+        const LeafNode* leaf() const { return reinterpret_cast<const LeafNode*>(page_.data()); }
+
+        BufferPool* pool_;
+        PageHandle page_;
+        int pos_;
+    };
+
+private:
+    static constexpr PageId kNoPage = UINT32_MAX;
+    static constexpr char kMagic[8] = {'B', 'P', 'T', 'R', 'E', 'E', '0', '1'};
+
+    // 元数据页
+    struct Meta
+    {
+        char magic[8];
+        uint32_t pageSize;
+        uint32_t keySize;
+        uint32_t valueSize;
+        PageId root;
+        PageId freeHead; // 空闲页链表，空闲页的前4个字节存放下一个空闲页
+        uint64_t size;
+    };
+
+    struct NodeBase
+    {
+        uint32_t leaf;
+        int32_t keyCount;
+    };
+
+    // 阶数按页大小计算，每个节点多留一个位置，插入后再分裂
+    static constexpr int kIndexOrder =
+        (PageSize - sizeof(NodeBase) - 2 * sizeof(PageId)) / (sizeof(Key) + sizeof(PageId));
+    static constexpr int kLeafOrder =
+        (PageSize - sizeof(NodeBase) - sizeof(PageId) - alignof(Value)) / (sizeof(Key) + sizeof(Value));
+
+    static constexpr int kMaxIndexKeys = kIndexOrder - 1;
+    static constexpr int kMinIndexKeys = (kIndexOrder + 1) / 2 - 1;
+    static constexpr int kMaxLeafKeys = kLeafOrder - 1;
+    static constexpr int kMinLeafKeys = (kLeafOrder + 1) / 2 - 1;
+
+    // 索引节点
+    struct IndexNode : NodeBase
+    {
+        KeyType keys[kIndexOrder];
+        PageId childs[kIndexOrder + 1];
+    };
+
+    // 叶子节点
+    struct LeafNode : NodeBase
+    {
+        PageId next;
+        KeyType keys[kLeafOrder];
+        ValueType values[kLeafOrder];
+    };
+
+    static_assert(kIndexOrder >= 3 && kLeafOrder >= 3, "PageSize too small");
+    static_assert(sizeof(IndexNode) <= PageSize && sizeof(LeafNode) <= PageSize, "node exceeds page");
+
+    // 路径上的索引节点及所走的子节点位置
+    struct PathEntry
+    {
+        PageHandle page;
+        int pos;
+    };
+
+    static NodeBase* base(const PageHandle& page) { return reinterpret_cast<NodeBase*>(page.data()); }
+    static IndexNode* index(const PageHandle& page) { return reinterpret_cast<IndexNode*>(page.data()); }
+    static LeafNode* leaf(const PageHandle& page) { return reinterpret_cast<LeafNode*>(page.data()); }
+
+    // 从根节点查找key所在的叶子，路径上的索引节点记入path
+    PageHandle descend(const KeyType& key, std::vector<PathEntry>* path);
+
+    PageHandle newNode(bool isLeaf);
+    void freeNode(PageHandle& page);
+
+    // 叶子节点/索引节点的键数量不足时，向兄弟借键或合并
+    void fixLeaf(PageHandle& page, std::vector<PathEntry>& path);
+    void fixIndex(std::vector<PathEntry>& path);
+
+    PageFile file_;
+    std::unique_ptr<BufferPool> pool_;
+    PageId root_;
+    PageId freeHead_;
+    size_t size_;
+};
+
+template <class Key, class Value, int PageSize>
+constexpr PageId DiskBPlusTree<Key, Value, PageSize>::kNoPage;
+
+template <class Key, class Value, int PageSize>
+constexpr char DiskBPlusTree<Key, Value, PageSize>::kMagic[8];
+
+
+template <class Key, class Value, int PageSize>
+bool DiskBPlusTree<Key, Value, PageSize>::
+open(const std::string& path, int poolPages, bool truncate)
+{
+    close();
+    if (!file_.open(path, PageSize, truncate)) return false;
+    pool_.reset(new BufferPool(file_, poolPages < 16 ? 16 : poolPages));
+
+    if (file_.pageCount() == 0) // 新文件
+    {
+        PageHandle meta = pool_->newPage();
+        root_ = kNoPage;
+        freeHead_ = kNoPage;
+        size_ = 0;
+        meta.release();
+        flush();
+        return true;
+    }
+    PageHandle page = pool_->fetch(0);
+    const Meta* meta = reinterpret_cast<const Meta*>(page.data());
+    if (std::memcmp(meta->magic, kMagic, sizeof(kMagic)) != 0 || meta->pageSize != PageSize ||
+        meta->keySize != sizeof(Key) || meta->valueSize != sizeof(Value))
+    {
+        page.release();
+        pool_.reset();
+        file_.close();
+        return false;
+    }
+    root_ = meta->root;
+    freeHead_ = meta->freeHead;
+    size_ = meta->size;
+    return true;
+}
+
+
+template <class Key, class Value, int PageSize>
+void DiskBPlusTree<Key, Value, PageSize>::flush()
+{
+    PageHandle page = pool_->fetch(0);
+    Meta* meta = reinterpret_cast<Meta*>(page.data());
+    std::memcpy(meta->magic, kMagic, sizeof(kMagic));
+    meta->pageSize = PageSize;
+    meta->keySize = sizeof(Key);
+    meta->valueSize = sizeof(Value);
+    meta->root = root_;
+    meta->freeHead = freeHead_;
+    meta->size = size_;
+    page.markDirty();
+    page.release();
+    pool_->flush();
+}
+
+
+template <class Key, class Value, int PageSize>
+PageHandle DiskBPlusTree<Key, Value, PageSize>::
+descend(const KeyType& key, std::vector<PathEntry>* path)
+{
+    PageHandle page = pool_->fetch(root_);
+    while (!base(page)->leaf)
+    {
+        IndexNode* node = index(page);
+        int pos = nodeUpperBound(node->keys, node->keyCount, key);
+        PageHandle child = pool_->fetch(node->childs[pos]);
+        if (path) path->push_back({std::move(page), pos});
+        page = std::move(child);
+    }
+    return page;
+}
+
+
+template <class Key, class Value, int PageSize>
+bool DiskBPlusTree<Key, Value, PageSize>::find(const KeyType& key, ValueType& value)
+{
+    if (root_ == kNoPage) return false;
+    PageHandle page = descend(key, nullptr);
+    const LeafNode* node = leaf(page);
+    int pos = nodeLowerBound(node->keys, node->keyCount, key);
+    if (pos == node->keyCount || !(node->keys[pos] == key)) return false;
+    value = node->values[pos];
+    return true;
+}
+
+
+template <class Key, class Value, int PageSize>
+auto DiskBPlusTree<Key, Value, PageSize>::begin() -> ConstIterator
+{
+    if (root_ == kNoPage) return end();
+    PageHandle page = pool_->fetch(root_);
+    while (!base(page)->leaf) page = pool_->fetch(index(page)->childs[0]);
+    return ConstIterator(pool_.get(), std::move(page));
+}
+
+
+template <class Key, class Value, int PageSize>
+PageHandle DiskBPlusTree<Key, Value, PageSize>::newNode(bool isLeaf)
+{
+    PageHandle page;
+    if (freeHead_ != kNoPage)
+    {
+        page = pool_->fetch(freeHead_);
+        std::memcpy(&freeHead_, page.data(), sizeof(PageId));
+        std::memset(page.data(), 0, PageSize);
+    }
+    else
+    {
+        page = pool_->newPage();
+    }
+    base(page)->leaf = isLeaf;
+    base(page)->keyCount = 0;
+    if (isLeaf) leaf(page)->next = kNoPage;
+    page.markDirty();
+    return page;
+}
+
+
+template <class Key, class Value, int PageSize>
+void DiskBPlusTree<Key, Value, PageSize>::freeNode(PageHandle& page)
+{
+    std::memcpy(page.data(), &freeHead_, sizeof(PageId));
+    freeHead_ = page.id();
+    page.markDirty();
+    page.release();
+}
+
+
+template <class Key, class Value, int PageSize>
+bool DiskBPlusTree<Key, Value, PageSize>::insert(const KeyType& key, const ValueType& value)
+{
+    if (root_ == kNoPage) root_ = newNode(true).id();
+
+    std::vector<PathEntry> path;
+    PageHandle page = descend(key, &path);
+    LeafNode* cur = leaf(page);
+    int pos = nodeLowerBound(cur->keys, cur->keyCount, key);
+    if (pos < cur->keyCount && cur->keys[pos] == key) return false;
+
+    for (int i = cur->keyCount; i > pos; --i)
+    {
+        cur->keys[i] = cur->keys[i - 1];
+        cur->values[i] = cur->values[i - 1];
+    }
+    cur->keys[pos] = key;
+    cur->values[pos] = value;
+    ++cur->keyCount;
+    ++size_;
+    page.markDirty();
+
+    if (cur->keyCount <= kMaxLeafKeys) return true;
+
+    // 分裂叶子节点
+    PageHandle brotherPage = newNode(true);
+    LeafNode* brother = leaf(brotherPage);
+    int mid = kLeafOrder / 2;
+    brother->keyCount = cur->keyCount - mid;
+    std::memcpy(brother->keys, cur->keys + mid, brother->keyCount * sizeof(KeyType));
+    std::memcpy(brother->values, cur->values + mid, brother->keyCount * sizeof(ValueType));
+    cur->keyCount = mid;
+    brother->next = cur->next;
+    cur->next = brotherPage.id();
+
+    // 分隔键和新节点插入父节点，父节点溢出时继续分裂
+    KeyType sep = brother->keys[0];
+    PageId left = page.id();
+    PageId right = brotherPage.id();
+    while (!path.empty())
+    {
+        PageHandle parentPage = std::move(path.back().page);
+        pos = path.back().pos;
+        path.pop_back();
+
+        IndexNode* parent = index(parentPage);
+        for (int i = parent->keyCount; i > pos; --i)
+        {
+            parent->keys[i] = parent->keys[i - 1];
+            parent->childs[i + 1] = parent->childs[i];
+        }
+        parent->keys[pos] = sep;
+        parent->childs[pos + 1] = right;
+        ++parent->keyCount;
+        parentPage.markDirty();
+
+        if (parent->keyCount <= kMaxIndexKeys) return true;
+
+        // 分裂索引节点，中间的键上移
+        PageHandle indexPage = newNode(false);
+        IndexNode* indexBrother = index(indexPage);
+        mid = kIndexOrder / 2;
+        indexBrother->keyCount = parent->keyCount - mid - 1;
+        std::memcpy(indexBrother->keys, parent->keys + mid + 1, indexBrother->keyCount * sizeof(KeyType));
+        std::memcpy(indexBrother->childs, parent->childs + mid + 1, (indexBrother->keyCount + 1) * sizeof(PageId));
+        sep = parent->keys[mid];
+        parent->keyCount = mid;
+        left = parentPage.id();
+        right = indexPage.id();
+    }
+
+    // 根节点分裂，树增高一层
+    PageHandle rootPage = newNode(false);
+    IndexNode* root = index(rootPage);
+    root->keys[0] = sep;
+    root->childs[0] = left;
+    root->childs[1] = right;
+    root->keyCount = 1;
+    root_ = rootPage.id();
+    return true;
+}
+
+
+template <class Key, class Value, int PageSize>
+bool DiskBPlusTree<Key, Value, PageSize>::remove(const KeyType& key)
+{
+    if (root_ == kNoPage) return false;
+
+    std::vector<PathEntry> path;
+    PageHandle page = descend(key, &path);
+    LeafNode* cur = leaf(page);
+    int pos = nodeLowerBound(cur->keys, cur->keyCount, key);
+    if (pos == cur->keyCount || !(cur->keys[pos] == key)) return false;
+
+    for (int i = pos; i < cur->keyCount - 1; ++i)
+    {
+        cur->keys[i] = cur->keys[i + 1];
+        cur->values[i] = cur->values[i + 1];
+    }
+    --cur->keyCount;
+    --size_;
+    page.markDirty();
+
+    if (cur->keyCount >= kMinLeafKeys) return true; // 键数量足够，结束
+    if (path.empty()) // 根节点
+    {
+        if (cur->keyCount == 0)
+        {
+            freeNode(page);
+            root_ = kNoPage;
+        }
+        return true;
+    }
+    fixLeaf(page, path);
+    return true;
+}
+
+
+template <class Key, class Value, int PageSize>
+void DiskBPlusTree<Key, Value, PageSize>::
+fixLeaf(PageHandle& page, std::vector<PathEntry>& path)
+{
+    LeafNode* cur = leaf(page);
+    PageHandle& parentPage = path.back().page;
+    IndexNode* parent = index(parentPage);
+    int childPos = path.back().pos;
+    parentPage.markDirty();
+
+    PageHandle leftPage, rightPage;
+    // 如果左兄弟的键数量足够，向其借一个
+    if (childPos > 0)
+    {
+        leftPage = pool_->fetch(parent->childs[childPos - 1]);
+        LeafNode* left = leaf(leftPage);
+        if (left->keyCount > kMinLeafKeys)
+        {
+            for (int i = cur->keyCount; i > 0; --i)
+            {
+                cur->keys[i] = cur->keys[i - 1];
+                cur->values[i] = cur->values[i - 1];
+            }
+            cur->keys[0] = left->keys[left->keyCount - 1];
+            cur->values[0] = left->values[left->keyCount - 1];
+            parent->keys[childPos - 1] = cur->keys[0];
+            ++cur->keyCount;
+            --left->keyCount;
+            leftPage.markDirty();
+            return;
+        }
+    }
+    // 如果右兄弟的键数量足够，向其借一个
+    if (childPos < parent->keyCount)
+    {
+        rightPage = pool_->fetch(parent->childs[childPos + 1]);
+        LeafNode* right = leaf(rightPage);
+        if (right->keyCount > kMinLeafKeys)
+        {
+            cur->keys[cur->keyCount] = right->keys[0];
+            cur->values[cur->keyCount] = right->values[0];
+            ++cur->keyCount;
+            for (int i = 0; i < right->keyCount - 1; ++i)
+            {
+                right->keys[i] = right->keys[i + 1];
+                right->values[i] = right->values[i + 1];
+            }
+            --right->keyCount;
+            parent->keys[childPos] = right->keys[0];
+            rightPage.markDirty();
+            return;
+        }
+    }
+
+    // 兄弟节点的键数量不足，合并节点：右节点并入左节点，删除父节点中的分隔键
+    int sepPos = childPos > 0 ? childPos - 1 : childPos;
+    PageHandle& dstPage = childPos > 0 ? leftPage : page;
+    PageHandle& srcPage = childPos > 0 ? page : rightPage;
+    LeafNode* dst = leaf(dstPage);
+    LeafNode* src = leaf(srcPage);
+    std::memcpy(dst->keys + dst->keyCount, src->keys, src->keyCount * sizeof(KeyType));
+    std::memcpy(dst->values + dst->keyCount, src->values, src->keyCount * sizeof(ValueType));
+    dst->keyCount += src->keyCount;
+    dst->next = src->next;
+    dstPage.markDirty();
+    freeNode(srcPage);
+
+    for (int i = sepPos; i < parent->keyCount - 1; ++i)
+    {
+        parent->keys[i] = parent->keys[i + 1];
+        parent->childs[i + 1] = parent->childs[i + 2];
+    }
+    --parent->keyCount;
+    fixIndex(path);
+}
+
+
+template <class Key, class Value, int PageSize>
+void DiskBPlusTree<Key, Value, PageSize>::fixIndex(std::vector<PathEntry>& path)
+{
+    while (index(path.back().page)->keyCount < kMinIndexKeys)
+    {
+        PageHandle& page = path.back().page;
+        IndexNode* cur = index(page);
+        if (path.size() == 1) // 根节点
+        {
+            if (cur->keyCount == 0)
+            {
+                root_ = cur->childs[0];
+                freeNode(page);
+            }
+            return;
+        }
+        PageHandle& parentPage = path[path.size() - 2].page;
+        IndexNode* parent = index(parentPage);
+        int childPos = path[path.size() - 2].pos;
+        parentPage.markDirty();
+        page.markDirty();
+
+        PageHandle leftPage, rightPage;
+        if (childPos > 0)
+        {
+            leftPage = pool_->fetch(parent->childs[childPos - 1]);
+            IndexNode* left = index(leftPage);
+            if (left->keyCount > kMinIndexKeys)
+            {
+                for (int i = cur->keyCount; i > 0; --i) cur->keys[i] = cur->keys[i - 1];
+                for (int i = cur->keyCount + 1; i > 0; --i) cur->childs[i] = cur->childs[i - 1];
+                cur->keys[0] = parent->keys[childPos - 1];
+                cur->childs[0] = left->childs[left->keyCount];
+                parent->keys[childPos - 1] = left->keys[left->keyCount - 1];
+                ++cur->keyCount;
+                --left->keyCount;
+                leftPage.markDirty();
+                return;
+            }
+        }
+        if (childPos < parent->keyCount)
+        {
+            rightPage = pool_->fetch(parent->childs[childPos + 1]);
+            IndexNode* right = index(rightPage);
+            if (right->keyCount > kMinIndexKeys)
+            {
+                cur->keys[cur->keyCount] = parent->keys[childPos];
+                cur->childs[cur->keyCount + 1] = right->childs[0];
+                parent->keys[childPos] = right->keys[0];
+                ++cur->keyCount;
+                for (int i = 0; i < right->keyCount - 1; ++i) right->keys[i] = right->keys[i + 1];
+                for (int i = 0; i < right->keyCount; ++i) right->childs[i] = right->childs[i + 1];
+                --right->keyCount;
+                rightPage.markDirty();
+                return;
+            }
+        }
+
+        // 合并：父节点中的分隔键下移到左节点
+        int sepPos = childPos > 0 ? childPos - 1 : childPos;
+        PageHandle& dstPage = childPos > 0 ? leftPage : page;
+        PageHandle& srcPage = childPos > 0 ? page : rightPage;
+        IndexNode* dst = index(dstPage);
+        IndexNode* src = index(srcPage);
+        dst->keys[dst->keyCount] = parent->keys[sepPos];
+        std::memcpy(dst->keys + dst->keyCount + 1, src->keys, src->keyCount * sizeof(KeyType));
+        std::memcpy(dst->childs + dst->keyCount + 1, src->childs, (src->keyCount + 1) * sizeof(PageId));
+        dst->keyCount += src->keyCount + 1;
+        dstPage.markDirty();
+        freeNode(srcPage);
+
+        for (int i = sepPos; i < parent->keyCount - 1; ++i)
+        {
+            parent->keys[i] = parent->keys[i + 1];
+            parent->childs[i + 1] = parent->childs[i + 2];
+        }
+        --parent->keyCount;
+        path.pop_back();
+    }
+}
+
+
+// 测试
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+
+int main()
+{
+    using namespace std;
+    using namespace std::chrono;
+
+    const char* path = "disk_b_plus_tree.db";
+    const int n = 1000000;
+
+    vector<int> keys(n);
+    for (int i = 0; i < n; ++i) keys[i] = i * 2;
+    shuffle(keys.begin(), keys.end(), mt19937(1));
+
+    // 缓冲池只有256页（1MB），约为数据量的1/20
+    DiskBPlusTree<int, long> tree;
+    if (!tree.open(path, 256, true)) return 1;
+
+    auto start = steady_clock::now();
+    for (int key : keys) tree.insert(key, key * 10L);
+    double insertMs = duration<double, milli>(steady_clock::now() - start).count();
+    tree.flush();
+    cout << "size: " << tree.size() << ", pages: " << tree.pageCount()
+         << ", insert: " << insertMs << " ms, hit ratio: " << tree.poolStats().hitRatio() << endl;
+
+    // 随机查找，一半命中一半不存在
+    tree.resetPoolStats();
+    mt19937 rng(2);
+    int found = 0;
+    start = steady_clock::now();
+    for (int i = 0; i < n; ++i)
+    {
+        long value;
+        int key = rng() % (2 * n);
+        if (tree.find(key, value) && value == key * 10L) ++found;
+    }
+    double findMs = duration<double, milli>(steady_clock::now() - start).count();
+    auto stats = tree.poolStats();
+    cout << "found: " << found << ", find: " << findMs << " ms, hit ratio: " << stats.hitRatio()
+         << ", evictions: " << stats.evictions << endl;
+
+    // 删除一半，叶子链表仍然有序
+    for (int i = 0; i < n / 2; ++i) tree.remove(keys[i]);
+    int count = 0;
+    bool sorted = true;
+    int prev = -1;
+    for (auto it = tree.begin(); it != tree.end(); ++it)
+    {
+        if (it.key() <= prev || *it != it.key() * 10L) sorted = false;
+        prev = it.key();
+        ++count;
+    }
+    cout << "after remove: " << tree.size() << " " << count << " " << sorted << endl;
+
+    // 重新打开文件，数据仍在；再插入时复用空闲页
+    tree.close();
+    DiskBPlusTree<int, long> reopened;
+    if (!reopened.open(path, 64)) return 1;
+    PageId pages = reopened.pageCount();
+    for (int i = 0; i < n / 4; ++i) reopened.insert(keys[i], keys[i] * 10L);
+    cout << "reopened: " << reopened.size() << " " << reopened.contains(keys[n - 1])
+         << " " << reopened.contains(keys[0]) << ", new pages: " << reopened.pageCount() - pages << endl;
+
+    reopened.close();
+    std::remove(path);
+    return 0;
+}
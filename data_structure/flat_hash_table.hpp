@@ -0,0 +1,546 @@
+#ifndef FLAT_HASH_TABLE_HPP
+#define FLAT_HASH_TABLE_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// 开放寻址哈希表（扁平存储）
+// 控制字节单独存放在一个数组中，每次以16个槽位为一组进行探测；
+// 支持SSE2时一组的匹配只需一次比较和movemask
+template <class Object, class HashFunc = std::hash<Object>,
+          class ExtractKey = std::_Identity<Object>>
+class FlatHashTable
+{
+    template <class TablePtr, class ObjectPtr> struct IteratorT;
+public:
+    using Iterator = IteratorT<FlatHashTable*, Object*>;
+    using ConstIterator = IteratorT<const FlatHashTable*, const Object*>;
+    using KeyType = typename std::result_of<ExtractKey(Object)>::type;
+
+    FlatHashTable(int n = 32)
+        : ctrl_(nullptr), slots_(nullptr), capacity_(0), size_(0), growthLeft_(0)
+    { initSlots(n); }
+
+    // 用[first, last)内的元素构造，threadCount见insertRange
+    template <class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+    FlatHashTable(InputIt first, InputIt last, int threadCount = 1): FlatHashTable()
+    { insertRange(first, last, threadCount); }
+
+    ~FlatHashTable() { destroy(); }
+
+    // 拷贝构造函数
+    FlatHashTable(const FlatHashTable& rhs): FlatHashTable(rhs.capacity_)
+    {
+        for (int i = 0; i < rhs.capacity_; ++i)
+        {
+            if (isFull(rhs.ctrl_[i])) _insert(*rhs.slot(i));
+        }
+    }
+
+    // 移动构造函数
+    FlatHashTable(FlatHashTable&& rhs) noexcept
+        : ctrl_(nullptr), slots_(nullptr), capacity_(0), size_(0), growthLeft_(0)
+    { swap(rhs); }
+
+    // 拷贝赋值运算符
+    FlatHashTable& operator=(const FlatHashTable& rhs)
+    {
+        FlatHashTable copy = rhs;
+        swap(copy);
+        return *this;
+    }
+
+    // 移动赋值运算符
+    FlatHashTable& operator=(FlatHashTable&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            destroy();
+            swap(rhs);
+        }
+        return *this;
+    }
+
+    void swap(FlatHashTable& rhs) noexcept
+    {
+        using std::swap;
+        swap(ctrl_, rhs.ctrl_);
+        swap(slots_, rhs.slots_);
+        swap(capacity_, rhs.capacity_);
+        swap(size_, rhs.size_);
+        swap(growthLeft_, rhs.growthLeft_);
+    }
+
+    // 插入元素（不重复）
+    std::pair<Iterator, bool> insert(const Object& obj)
+    { return _insert(obj); }
+
+    std::pair<Iterator, bool> insert(Object&& obj)
+    { return _insert(std::move(obj)); }
+
+    // 查找
+    ConstIterator find(const KeyType& key) const
+    { return find(key, hashCode(key)); }
+
+    Iterator find(const KeyType& key)
+    { return find(key, hashCode(key)); }
+
+    // hash为调用者预先计算的hashCode(key)，一次计算可用于查找多个表
+    ConstIterator find(const KeyType& key, size_t hash) const
+    { return ConstIterator(this, _find(key, hash)); }
+
+    Iterator find(const KeyType& key, size_t hash)
+    { return Iterator(this, _find(key, hash)); }
+
+    // 透明查找：HashFunc定义了is_transparent时，可用任何与key可比较（==）
+    // 且哈希值一致的类型查找
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    ConstIterator find(const K& key) const
+    { return find(key, hashCode(key)); }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    Iterator find(const K& key)
+    { return find(key, hashCode(key)); }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    ConstIterator find(const K& key, size_t hash) const
+    { return ConstIterator(this, _find(key, hash)); }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    Iterator find(const K& key, size_t hash)
+    { return Iterator(this, _find(key, hash)); }
+
+    int count(const KeyType& key) const { return _find(key, hashCode(key)) != capacity_; }
+    int count(const KeyType& key, size_t hash) const { return _find(key, hash) != capacity_; }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    int count(const K& key) const { return _find(key, hashCode(key)) != capacity_; }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    int count(const K& key, size_t hash) const { return _find(key, hash) != capacity_; }
+
+    // key的哈希值，供预先计算哈希的查找接口使用
+    template <class K>
+    static size_t hashCode(const K& key)
+    { return HashFunc()(key); }
+
+    // 插入[first, last)内的元素（不重复），前向迭代器按元素个数只扩容一次。
+    // threadCount只为与HashTable的接口一致：探测序列会跨越任意位置的组，
+    // 无法像链地址法那样按桶区间划分给各线程，总是在当前线程插入
+    template <class InputIt>
+    void insertRange(InputIt first, InputIt last, int threadCount = 1)
+    {
+        (void)threadCount;
+        insertRange(first, last, typename std::iterator_traits<InputIt>::iterator_category());
+    }
+
+    // 查找（不存在则插入）
+    Object& findOrInsert(const Object& obj)
+    { return *insert(obj).first; }
+
+    Object& findOrInsert(Object&& obj)
+    { return *insert(std::move(obj)).first; }
+
+    // 删除
+    bool remove(const KeyType& key) { return _remove(key, hashCode(key)); }
+    bool remove(const KeyType& key, size_t hash) { return _remove(key, hash); }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    bool remove(const K& key) { return _remove(key, hashCode(key)); }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    bool remove(const K& key, size_t hash) { return _remove(key, hash); }
+
+    void clear();
+
+    int size() const { return size_; }
+    int bucketCount() const { return capacity_; }
+
+    ConstIterator begin() const { return ConstIterator(this, nextFull(0)); }
+    Iterator begin() { return Iterator(this, nextFull(0)); }
+
+    ConstIterator end() const { return ConstIterator(this, capacity_); }
+    Iterator end() { return Iterator(this, capacity_); }
+
+private:
+    static constexpr int kGroupWidth = 16;
+
+    // 控制字节：空槽、已删除槽（墓碑）为负数，已占用槽存放哈希值的低7位
+    static constexpr int8_t kEmpty = -128;
+    static constexpr int8_t kDeleted = -2;
+
+    using Slot = typename std::aligned_storage<sizeof(Object), alignof(Object)>::type;
+
+    // 一组控制字节的匹配结果，第i位为1表示组内第i个槽位匹配
+    struct BitMask
+    {
+        uint32_t mask;
+
+        explicit operator bool() const { return mask != 0; }
+        int lowest() const { return __builtin_ctz(mask); }
+        void clearLowest() { mask &= mask - 1; }
+    };
+
+    // 16个控制字节组成的探测组
+    struct Group
+    {
+#ifdef __SSE2__
+        __m128i ctrl;
+
+        explicit Group(const int8_t* pos)
+            : ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+        BitMask match(int8_t h2) const
+        {
+            __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl);
+            return {static_cast<uint32_t>(_mm_movemask_epi8(cmp))};
+        }
+
+        BitMask matchEmpty() const { return match(kEmpty); }
+
+        // 空槽和已删除槽的控制字节均为负数，取符号位即可
+        BitMask matchEmptyOrDeleted() const
+        { return {static_cast<uint32_t>(_mm_movemask_epi8(ctrl))}; }
+#else
+        const int8_t* ctrl;
+
+        explicit Group(const int8_t* pos): ctrl(pos) {}
+
+        BitMask match(int8_t h2) const
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < kGroupWidth; ++i)
+            {
+                if (ctrl[i] == h2) mask |= 1u << i;
+            }
+            return {mask};
+        }
+
+        BitMask matchEmpty() const { return match(kEmpty); }
+
+        BitMask matchEmptyOrDeleted() const
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < kGroupWidth; ++i)
+            {
+                if (ctrl[i] < 0) mask |= 1u << i;
+            }
+            return {mask};
+        }
+#endif
+    };
+
+    template <class X>
+    std::pair<Iterator, bool> _insert(X&& obj);
+
+    // hash为HashFunc得到的哈希值
+    template <class K>
+    int _find(const K& key, size_t hash) const;
+
+    template <class K>
+    bool _remove(const K& key, size_t hash);
+
+    template <class InputIt>
+    void insertRange(InputIt first, InputIt last, std::input_iterator_tag)
+    {
+        for (; first != last; ++first) _insert(*first);
+    }
+
+    template <class ForwardIt>
+    void insertRange(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+    {
+        reserve(size_ + (int)std::distance(first, last));
+        for (; first != last; ++first) _insert(*first);
+    }
+
+    // 扩容到可容纳n个元素而不再重建
+    void reserve(int n)
+    {
+        if (capacity_ > 0 && n <= size_ + growthLeft_) return;
+        int capacity = capacity_ > kGroupWidth ? capacity_ : kGroupWidth;
+        while (maxLoad(capacity) < n) capacity *= 2;
+        rehash(capacity);
+    }
+
+    // 查找可插入的位置（空槽或已删除槽）
+    int findInsertPos(size_t hash) const;
+
+    void rehash(int newCapacity);
+
+    void initSlots(int n)
+    {
+        capacity_ = roundup(n < kGroupWidth ? kGroupWidth : n);
+        ctrl_ = static_cast<int8_t*>(::aligned_alloc(kGroupWidth, capacity_));
+        ::memset(ctrl_, kEmpty, capacity_);
+        slots_ = static_cast<Slot*>(::operator new(sizeof(Slot) * capacity_));
+        size_ = 0;
+        growthLeft_ = maxLoad(capacity_);
+    }
+
+    // 析构所有元素并释放存储
+    void destroy()
+    {
+        if (!ctrl_) return;
+        for (int i = 0; i < capacity_; ++i)
+        {
+            if (isFull(ctrl_[i])) slot(i)->~Object();
+        }
+        ::free(ctrl_);
+        ::operator delete(slots_);
+        ctrl_ = nullptr;
+        slots_ = nullptr;
+        capacity_ = size_ = growthLeft_ = 0;
+    }
+
+    void setCtrl(int pos, int8_t h) { ctrl_[pos] = h; }
+
+    Object* slot(int pos) { return reinterpret_cast<Object*>(&slots_[pos]); }
+    const Object* slot(int pos) const { return reinterpret_cast<const Object*>(&slots_[pos]); }
+
+    int nextFull(int pos) const
+    {
+        while (pos < capacity_ && !isFull(ctrl_[pos])) ++pos;
+        return pos;
+    }
+
+    // 对用户哈希值再做一次混合，避免std::hash<int>等恒等哈希的低位聚集
+    static size_t hashOf(const KeyType& key)
+    { return mix(hashCode(key)); }
+
+    static size_t mix(size_t hash)
+    {
+        uint64_t h = static_cast<uint64_t>(hash);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+
+    // 高位用于定位探测组，低7位存入控制字节
+    static size_t h1(size_t hash) { return hash >> 7; }
+    static int8_t h2(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+    static bool isFull(int8_t c) { return c >= 0; }
+
+    // 最大装载因子7/8
+    static int maxLoad(int capacity) { return capacity - capacity / 8; }
+
+    static int roundup(int n)
+    { return roundupPowerOfTwo(n); }
+
+    // 取整为2的幂次方
+    static unsigned int roundupPowerOfTwo(unsigned int i)
+    {
+        --i;
+        i |= i >> 1;
+        i |= i >> 2;
+        i |= i >> 4;
+        i |= i >> 8;
+        i |= i >> 16;
+        return i + 1;
+    }
+
+    static const KeyType& getKey(const Object& obj)
+    { return ExtractKey()(obj); }
+
+    // 探测序列：以组为单位的二次探测，组号依次偏移1,2,3...
+    struct ProbeSeq
+    {
+        size_t mask;
+        size_t group;
+        size_t index = 0;
+
+        ProbeSeq(size_t hash, int capacity)
+            : mask(capacity / kGroupWidth - 1), group(h1(hash) & mask) {}
+
+        int offset() const { return static_cast<int>(group * kGroupWidth); }
+        void next() { group = (group + ++index) & mask; }
+    };
+
+    // 迭代器
+    template <class TablePtr, class ObjectPtr>
+    struct IteratorT
+    {
+        TablePtr tab;
+        int pos;
+
+        using Self = IteratorT;
+        using ObjectRef = decltype(*std::declval<ObjectPtr>());
+
+        IteratorT() {}
+        IteratorT(TablePtr _tab, int _pos): tab(_tab), pos(_pos) {}
+
+        bool operator==(const Self& it) const { return pos == it.pos; }
+        bool operator!=(const Self& it) const { return pos != it.pos; }
+
+        ObjectRef operator*() const { return *tab->slot(pos); }
+        ObjectPtr operator->() const { return tab->slot(pos); }
+
+        Self& operator++()
+        {
+            pos = tab->nextFull(pos + 1);
+            return *this;
+        }
+
+        Self operator++(int)
+        {
+            Self tmp = *this;
+            ++*this;
+            return tmp;
+        }
+    };
+
+    int8_t* ctrl_; // 控制字节
+    Slot* slots_; // 元素存储
+    int capacity_;
+    int size_;
+    int growthLeft_; // 不触发重建还可占用的空槽数
+};
+
+
+template <class Object, class HashFunc, class ExtractKey>
+constexpr int FlatHashTable<Object, HashFunc, ExtractKey>::kGroupWidth;
+
+template <class Object, class HashFunc, class ExtractKey>
+constexpr int8_t FlatHashTable<Object, HashFunc, ExtractKey>::kEmpty;
+
+template <class Object, class HashFunc, class ExtractKey>
+constexpr int8_t FlatHashTable<Object, HashFunc, ExtractKey>::kDeleted;
+
+
+template <class Object, class HashFunc, class ExtractKey>
+template <class K>
+int FlatHashTable<Object, HashFunc, ExtractKey>::
+_find(const K& key, size_t hash) const
+{
+    if (capacity_ == 0) return capacity_; // 被移动后的空表
+    hash = mix(hash);
+    ProbeSeq seq(hash, capacity_);
+    while (true)
+    {
+        Group g(ctrl_ + seq.offset());
+        for (BitMask m = g.match(h2(hash)); m; m.clearLowest())
+        {
+            int pos = seq.offset() + m.lowest();
+            if (key == getKey(*slot(pos))) return pos;
+        }
+        // 组内有空槽说明探测序列到此为止
+        if (g.matchEmpty()) return capacity_;
+        seq.next();
+    }
+}
+
+
+template <class Object, class HashFunc, class ExtractKey>
+int FlatHashTable<Object, HashFunc, ExtractKey>::
+findInsertPos(size_t hash) const
+{
+    ProbeSeq seq(hash, capacity_);
+    while (true)
+    {
+        BitMask m = Group(ctrl_ + seq.offset()).matchEmptyOrDeleted();
+        if (m) return seq.offset() + m.lowest();
+        seq.next();
+    }
+}
+
+
+template <class Object, class HashFunc, class ExtractKey>
+template <class X>
+auto FlatHashTable<Object, HashFunc, ExtractKey>::
+_insert(X&& obj) -> std::pair<Iterator, bool>
+{
+    if (capacity_ == 0) initSlots(kGroupWidth);
+    size_t userHash = hashCode(getKey(obj));
+    int pos = _find(getKey(obj), userHash);
+    if (pos != capacity_) return {Iterator(this, pos), false};
+
+    size_t hash = mix(userHash);
+    pos = findInsertPos(hash);
+    // 没有可用空槽时重建：墓碑较多则原地清理，否则扩容
+    if (growthLeft_ == 0 && ctrl_[pos] == kEmpty)
+    {
+        rehash(size_ * 2 < maxLoad(capacity_) ? capacity_ : capacity_ * 2);
+        pos = findInsertPos(hash);
+    }
+    new (slot(pos)) Object(std::forward<X>(obj));
+    if (ctrl_[pos] == kEmpty) --growthLeft_;
+    setCtrl(pos, h2(hash));
+    ++size_;
+    return {Iterator(this, pos), true};
+}
+
+
+template <class Object, class HashFunc, class ExtractKey>
+template <class K>
+bool FlatHashTable<Object, HashFunc, ExtractKey>::
+_remove(const K& key, size_t hash)
+{
+    int pos = _find(key, hash);
+    if (pos == capacity_) return false;
+    slot(pos)->~Object();
+    --size_;
+    // 所在组仍有空槽时，探测不会越过该组，可直接置为空槽
+    int offset = pos - pos % kGroupWidth;
+    if (Group(ctrl_ + offset).matchEmpty())
+    {
+        setCtrl(pos, kEmpty);
+        ++growthLeft_;
+    }
+    else
+    {
+        setCtrl(pos, kDeleted);
+    }
+    return true;
+}
+
+
+template <class Object, class HashFunc, class ExtractKey>
+void FlatHashTable<Object, HashFunc, ExtractKey>::rehash(int newCapacity)
+{
+    int8_t* oldCtrl = ctrl_;
+    Slot* oldSlots = slots_;
+    int oldCapacity = capacity_;
+
+    initSlots(newCapacity);
+    for (int i = 0; i < oldCapacity; ++i)
+    {
+        if (!isFull(oldCtrl[i])) continue;
+        Object* old = reinterpret_cast<Object*>(&oldSlots[i]);
+        size_t hash = hashOf(getKey(*old));
+        int pos = findInsertPos(hash);
+        new (slot(pos)) Object(std::move(*old));
+        old->~Object();
+        setCtrl(pos, h2(hash));
+        ++size_;
+        --growthLeft_;
+    }
+    ::free(oldCtrl);
+    ::operator delete(oldSlots);
+}
+
+
+template <class Object, class HashFunc, class ExtractKey>
+void FlatHashTable<Object, HashFunc, ExtractKey>::clear()
+{
+    if (!ctrl_) return;
+    for (int i = 0; i < capacity_; ++i)
+    {
+        if (isFull(ctrl_[i])) slot(i)->~Object();
+    }
+    ::memset(ctrl_, kEmpty, capacity_);
+    size_ = 0;
+    growthLeft_ = maxLoad(capacity_);
+}
+
+
+#endif // FLAT_HASH_TABLE_HPP
@@ -1,8 +1,11 @@
 
 #include "hash_table.hpp"
+#include "flat_hash_table.hpp"
 
 // 基于哈希表的无序map
-template <class Key, class Value, class HashFunc = std::hash<Key>>
+// Table：底层哈希表，可选HashTable（链地址法）或FlatHashTable（开放寻址）
+template <class Key, class Value, class HashFunc = std::hash<Key>,
+          template <class...> class Table = HashTable>
 class HashMap
 {
 public:
@@ -14,7 +17,7 @@ public:
     };
 
     using Object = std::pair<const Key, Value>;
-    using MHashTable = HashTable<Object, HashFunc, select1st<Object>>;
+    using MHashTable = Table<Object, HashFunc, select1st<Object>>;
     using Iterator = typename MHashTable::Iterator;
     using ConstIterator = typename MHashTable::ConstIterator;
     using KeyType = typename MHashTable::KeyType;
@@ -32,12 +35,41 @@ public:
     Iterator find(const KeyType& key) { return table_.find(key);}
     ConstIterator find(const KeyType& key) const { return table_.find(key);}
 
+    // 透明查找（HashFunc需定义is_transparent，如StringHash），其他类型的key转发给底层哈希表
+    template <class K>
+    Iterator find(const K& key) { return table_.find(key); }
+
+    template <class K>
+    ConstIterator find(const K& key) const { return table_.find(key); }
+
+    // hash为预先计算的哈希值（hashCode(key)），一次计算可用于查找多个map
+    template <class K>
+    Iterator find(const K& key, size_t hash) { return table_.find(key, hash); }
+
+    template <class K>
+    ConstIterator find(const K& key, size_t hash) const { return table_.find(key, hash); }
+
+    template <class K>
+    int count(const K& key) const { return table_.count(key); }
+
+    template <class K>
+    int count(const K& key, size_t hash) const { return table_.count(key, hash); }
+
+    template <class K>
+    static size_t hashCode(const K& key) { return MHashTable::hashCode(key); }
+
     Value& operator[](const KeyType& key)
     { return table_.findOrInsert({key, Value()}).second; }
 
     // 删除   
     bool remove(const KeyType& key) { return table_.remove(key); }
 
+    template <class K>
+    bool remove(const K& key) { return table_.remove(key); }
+
+    template <class K>
+    bool remove(const K& key, size_t hash) { return table_.remove(key, hash); }
+
     void clear() { table_.clear(); }
     
     int size() const { return table_.size(); }
@@ -55,6 +87,7 @@ private:
 
 // 测试
 #include <iostream>
+#include <string>
 
 int main()
 {
@@ -79,6 +112,41 @@ int main()
     for (const auto& x : map) cout << x.second << " ";
     cout << endl;
 
+    HashMap<string, int, hash<string>, FlatHashTable> flatMap;
+    flatMap["one"] = 1;
+    flatMap["two"] = 2;
+    flatMap["three"] = 3;
+    flatMap.remove("two");
+
+    cout << flatMap.size() << endl;
+    cout << flatMap["three"] << endl;
+    cout << (flatMap.find("two") != flatMap.end()) << endl;
+
+    // 透明查找，用string_view查找时不构造std::string
+    HashMap<string, int, StringHash> strMap;
+    strMap["alpha"] = 1;
+    strMap["beta"] = 2;
+    const char buf[] = "alpha,beta,gamma";
+    experimental::string_view alpha(buf, 5), beta(buf + 6, 4), gamma(buf + 11, 5);
+    cout << strMap.find(alpha)->second << " " << strMap.count(gamma) << endl;
+
+    // 预先计算哈希值，查找多个map
+    HashMap<string, int, StringHash> other;
+    other["beta"] = 20;
+    size_t h = strMap.hashCode(beta);
+    cout << strMap.find(beta, h)->second << " " << other.find(beta, h)->second << endl;
+    strMap.remove("alpha");
+    cout << strMap.size() << endl;
+
+    // 开放寻址的底层哈希表同样支持透明查找和预先计算哈希值
+    HashMap<string, int, StringHash, FlatHashTable> flatStrMap;
+    flatStrMap["alpha"] = 1;
+    flatStrMap["beta"] = 2;
+    cout << flatStrMap.find(alpha)->second << " " << flatStrMap.count(gamma) << " "
+         << flatStrMap.find(beta, h)->second << " " << flatStrMap.count(beta, h) << endl;
+    flatStrMap.remove(alpha, flatStrMap.hashCode(alpha));
+    cout << flatStrMap.size() << " " << flatStrMap.count("alpha") << endl;
+
     return 0;
 }
 
@@ -1,18 +1,31 @@
 
 #include "hash_table.hpp"
+#include "flat_hash_table.hpp"
+#include "bloom_filter.hpp"
 
 // 基于哈希表的无序集合
-template <class Object, class HashFunc = std::hash<Object>>
+// Table：底层哈希表，可选HashTable（链地址法）或FlatHashTable（开放寻址）
+template <class Object, class HashFunc = std::hash<Object>,
+          template <class...> class Table = HashTable>
 class HashSet
 {
 public:
-    using MHashTable = HashTable<Object, HashFunc>;
+    using MHashTable = Table<Object, HashFunc, std::_Identity<Object>>;
     using Iterator = typename MHashTable::Iterator;
     using ConstIterator = typename MHashTable::ConstIterator;
     using KeyType = typename MHashTable::KeyType;
 
     HashSet(int n = 32): table_(n) {}
 
+    // 用[first, last)内的元素构造，只扩容一次，threadCount > 1时多线程插入
+    template <class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+    HashSet(InputIt first, InputIt last, int threadCount = 1)
+        : table_(first, last, threadCount) {}
+
+    template <class InputIt>
+    void insertRange(InputIt first, InputIt last, int threadCount = 1)
+    { table_.insertRange(first, last, threadCount); }
+
     // 插入
     std::pair<Iterator, bool> insert(const Object& obj)
     { return table_.insert(obj); }
@@ -24,6 +37,8 @@ public:
     Iterator find(const KeyType& key) {return table_.find(key);}
     ConstIterator find(const KeyType& key) const {return table_.find(key);}
 
+    bool contains(const KeyType& key) const { return find(key) != end(); }
+
     // 删除
     bool remove(const KeyType& key) { return table_.remove(key); }
 
@@ -44,6 +59,7 @@ private:
 
 // 测试
 #include <iostream>
+#include <vector>
 
 int main()
 {
@@ -68,6 +84,37 @@ int main()
     for (const auto& x : set) cout << x << " ";
     cout << endl;
 
+    HashSet<int, hash<int>, FlatHashTable> flatSet;
+    for (int i = 0; i < 100; ++i) flatSet.insert(i * 7);
+    for (int i = 0; i < 100; i += 2) flatSet.remove(i * 7);
+
+    cout << flatSet.size() << endl;
+    cout << (flatSet.find(7) != flatSet.end()) << endl;
+    cout << (flatSet.find(14) != flatSet.end()) << endl;
+
+    // 批量构造
+    vector<int> nums;
+    for (int i = 0; i < 1000; ++i) nums.push_back(i % 600);
+    HashSet<int> bulk(nums.begin(), nums.end());
+    HashSet<int> parallel(nums.begin(), nums.end(), 4);
+    cout << bulk.size() << " " << parallel.size() << " "
+         << (parallel.find(599) != parallel.end()) << endl;
+
+    HashSet<int, hash<int>, FlatHashTable> flatBulk(nums.begin(), nums.end(), 4);
+    flatBulk.insertRange(nums.begin(), nums.end());
+    cout << flatBulk.size() << " " << flatBulk.contains(599) << " " << flatBulk.contains(600) << endl;
+
+    // 布隆过滤器前置过滤
+    BloomFiltered<HashSet<int>> filtered(1000, 0.01);
+    for (int i = 0; i < 1000; ++i) filtered.insert(i * 2);
+    int hits = 0;
+    for (int i = 0; i < 2000; ++i) hits += filtered.contains(i);
+    cout << hits << " " << filtered.filteredCount() << " "
+         << filtered.filter().bitsPerKey() << endl;
+
+    BloomFiltered<HashSet<int>> byBits(BloomFilter<int>::withBitsPerKey(1000, 10));
+    cout << byBits.filter().bitsPerKey() << " " << byBits.filter().targetFpRate() << endl;
+
     return 0;
 }
 
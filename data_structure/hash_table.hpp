@@ -1,32 +1,96 @@
 #ifndef HASH_TABLE_HPP
 #define HASH_TABLE_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <experimental/string_view>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "node_pool.hpp"
+
+#ifdef HASH_TABLE_STATS
+#include "hash_table_stats.hpp"
+#endif
+
+// 节点中缓存的完整哈希值
+template <bool Cache>
+struct HashCodeCache
+{
+    size_t hash;
+};
+
+template <>
+struct HashCodeCache<false> {};
+
+
+// 字符串的透明哈希：std::string、const char*、string_view得到相同的哈希值（与std::hash<std::string>一致），
+// 配合透明查找可直接用网络缓冲区中的字符串片段查找，无需构造临时的std::string
+struct StringHash
+{
+    using is_transparent = void;
+
+    size_t operator()(const std::string& s) const
+    { return std::_Hash_impl::hash(s.data(), s.size()); }
+
+    size_t operator()(const char* s) const
+    { return std::_Hash_impl::hash(s, std::strlen(s)); }
+
+    size_t operator()(std::experimental::string_view s) const
+    { return std::_Hash_impl::hash(s.data(), s.size()); }
+};
+
+
 // 哈希表
+// Alloc：节点分配器，可使用NodePool复用节点内存
+// CacheHash：为std::true_type时节点缓存完整哈希值，rehash和迭代时不再重新计算哈希，
+//            查找时先比较哈希值，不同则跳过key的比较，适用于std::string等哈希和比较开销大的key
 template <class Object, class HashFunc = std::hash<Object>,
-          class ExtractKey = std::_Identity<Object>>
+          class ExtractKey = std::_Identity<Object>,
+          class Alloc = std::allocator<Object>,
+          class CacheHash = std::false_type>
 class HashTable
 {
     template <class NodePtr> struct IteratorT;
     struct Node;
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
+    using CacheTag = std::integral_constant<bool, CacheHash::value>;
 public:
     using Iterator = IteratorT<Node*>;
     using ConstIterator = IteratorT<const Node*>;
     using KeyType = typename std::result_of<ExtractKey(Object)>::type;
+    using Key = typename std::decay<KeyType>::type;
 
-    HashTable(int n = 32): nodeCount_(0) { initBuckets(n); }
+    HashTable(int n = 32): nodeCount_(0), rehashPos_(0), incremental_(false)
+    { initBuckets(n); }
     ~HashTable() { clear(); }
 
+    // 用[first, last)内的元素构造，threadCount见insertRange
+    template <class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+    HashTable(InputIt first, InputIt last, int threadCount = 1): HashTable()
+    { insertRange(first, last, threadCount); }
+
     // 拷贝构造函数
     HashTable(const HashTable& rhs);
 
     // 移动构造函数
     HashTable(HashTable&& rhs) noexcept
         : buckets_(std::move(rhs.buckets_)),
-          nodeCount_(rhs.nodeCount_)
-    { rhs.nodeCount_ = 0; }
+          oldBuckets_(std::move(rhs.oldBuckets_)),
+          nodeCount_(rhs.nodeCount_),
+          rehashPos_(rhs.rehashPos_),
+          incremental_(rhs.incremental_),
+          alloc_(std::move(rhs.alloc_))
+    {
+        rhs.nodeCount_ = 0;
+        rhs.rehashPos_ = 0;
+    }
 
     // 拷贝赋值运算符
     HashTable& operator=(const HashTable& rhs)
@@ -42,12 +106,29 @@ public:
         {
             clear();
             buckets_ = std::move(rhs.buckets_);
+            oldBuckets_ = std::move(rhs.oldBuckets_);
             nodeCount_ = rhs.nodeCount_;
+            rehashPos_ = rhs.rehashPos_;
+            incremental_ = rhs.incremental_;
+            alloc_ = std::move(rhs.alloc_);
             rhs.nodeCount_ = 0;
+            rhs.rehashPos_ = 0;
         }
         return *this;
     }
 
+    // 渐进式rehash：扩容时新旧两个桶数组并存，
+    // 之后每次insert/find/remove只迁移少量旧桶，避免一次性迁移造成的停顿。
+    // 迁移会移动节点，因此迁移期间一旦开始迭代（begin或迭代器前进），find/remove暂停迁移，
+    // 直到下一次插入（插入本就使迭代器失效），迭代不会遗漏或重复元素
+    void setIncrementalRehash(bool on)
+    {
+        if (!on) finishRehash();
+        incremental_ = on;
+    }
+
+    bool rehashing() const { return !oldBuckets_.empty(); }
+
     // 插入元素（不重复）
     std::pair<Iterator, bool> insert(const Object& obj)
     { return _insert(obj); }
@@ -61,10 +142,74 @@ public:
 
     // 查找
     ConstIterator find(const KeyType& key) const
-    { return ConstIterator(_find(key), this); }
+    { return find(key, hashCode(key)); }
 
     Iterator find(const KeyType& key)
-    { return Iterator(const_cast<Node*>(_find(key)), this); }
+    { return find(key, hashCode(key)); }
+
+    // hash为调用者预先计算的hashCode(key)，一次计算可用于查找多个表
+    ConstIterator find(const KeyType& key, size_t hash) const
+    { return ConstIterator(_find(key, hash), this); }
+
+    Iterator find(const KeyType& key, size_t hash)
+    {
+        lookupRehashStep();
+        return Iterator(const_cast<Node*>(_find(key, hash)), this);
+    }
+
+    // 透明查找：HashFunc定义了is_transparent时，可用任何与key可比较（==）
+    // 且哈希值一致的类型查找，如用const char*查找std::string
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    ConstIterator find(const K& key) const
+    { return find(key, hashCode(key)); }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    Iterator find(const K& key)
+    { return find(key, hashCode(key)); }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    ConstIterator find(const K& key, size_t hash) const
+    { return ConstIterator(_find(key, hash), this); }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    Iterator find(const K& key, size_t hash)
+    {
+        lookupRehashStep();
+        return Iterator(const_cast<Node*>(_find(key, hash)), this);
+    }
+
+    int count(const KeyType& key) const { return _find(key, hashCode(key)) != nullptr; }
+    int count(const KeyType& key, size_t hash) const { return _find(key, hash) != nullptr; }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    int count(const K& key) const { return _find(key, hashCode(key)) != nullptr; }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    int count(const K& key, size_t hash) const { return _find(key, hash) != nullptr; }
+
+    // key的哈希值，供预先计算哈希的查找接口使用
+    template <class K>
+    static size_t hashCode(const K& key)
+    { return HashFunc()(key); }
+
+    // 批量查找：先计算所有key的桶位置并预取桶头，再交错遍历各条链表，
+    // 使各次查找的访存延迟相互重叠。out[i]为keys[i]的查找结果
+    void findBatch(const Key* keys, int n, ConstIterator* out) const;
+    void findBatch(const Key* keys, int n, Iterator* out);
+
+    // 批量插入（不重复），out非空时写入每个元素的插入结果
+    void insertBatch(const Object* objs, int n, std::pair<Iterator, bool>* out = nullptr);
+
+    // 插入[first, last)内的元素（不重复）：按元素个数只扩容一次，
+    // 节点分配器支持reserve（如NodePool）时所有节点在一块连续内存中分配。
+    // threadCount > 1且为随机访问迭代器时多线程插入：按桶下标把元素划分给各线程，
+    // 各线程只修改自己负责的桶区间，节点由调用线程预先分配。元素的拷贝构造不能抛出异常
+    template <class InputIt>
+    void insertRange(InputIt first, InputIt last, int threadCount = 1)
+    {
+        insertRange(first, last, threadCount,
+                    typename std::iterator_traits<InputIt>::iterator_category());
+    }
 
     // 查找（不存在则插入）
     Object& findOrInsert(const Object& obj)
@@ -74,22 +219,52 @@ public:
     { return *insert(std::move(obj)).first; }
 
     // 删除
-    bool remove(const KeyType& key);
+    bool remove(const KeyType& key) { return _remove(key, hashCode(key)); }
+    bool remove(const KeyType& key, size_t hash) { return _remove(key, hash); }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    bool remove(const K& key) { return _remove(key, hashCode(key)); }
+
+    template <class K, class H = HashFunc, class = typename H::is_transparent>
+    bool remove(const K& key, size_t hash) { return _remove(key, hash); }
 
     void clear();
 
     int size() const { return nodeCount_; }
     int bucketCount() const { return buckets_.size(); }
 
-    ConstIterator begin() const { return ConstIterator(_begin(), this); }
-    Iterator begin() { return Iterator(const_cast<Node*>(_begin()), this); }
+    ConstIterator begin() const
+    {
+        markIterating();
+        return ConstIterator(_begin(), this);
+    }
+
+    Iterator begin()
+    {
+        markIterating();
+        return Iterator(const_cast<Node*>(_begin()), this);
+    }
 
     ConstIterator end() const { return ConstIterator(nullptr, this); }
     Iterator end() { return Iterator(nullptr, this); }
 
+#ifdef HASH_TABLE_STATS
+    // 统计信息，链表长度直方图在调用时遍历所有桶得到
+    HashTableStats stats() const;
+    void resetStats() { counters_.reset(); }
+#endif
+
 private:
 
-    const Node* _find(const KeyType& key) const;
+    template <class K>
+    const Node* _find(const K& key, size_t hash) const;
+
+    template <class K>
+    bool _remove(const K& key, size_t hash);
+
+    // 交错遍历各条链表，heads为各key所在链表的头节点
+    static void walkChains(const Key* const* keys, const size_t* hashes, int n,
+                           const Node** heads, const Node** out);
 
     template <class X>
     std::pair<Iterator, bool> _insert(X&& obj);
@@ -99,6 +274,79 @@ private:
 
     void resize(int hintCnt);
 
+    // 迁移若干个旧桶
+    void rehashStep();
+
+    // 迁移期间开始迭代，find/remove暂停迁移
+    void markIterating() const
+    {
+        if (rehashing()) iterating_.store(true, std::memory_order_relaxed);
+    }
+
+    // find/remove时迁移若干个旧桶，有迭代在进行时不迁移
+    void lookupRehashStep()
+    {
+        if (rehashing() && !iterating_.load(std::memory_order_relaxed)) rehashStep();
+    }
+
+    // 迁移剩余的全部旧桶
+    void finishRehash();
+
+    void moveBucket(Node*& first);
+
+    void copyBuckets(std::vector<Node*>& dst, const std::vector<Node*>& src);
+
+    template <class InputIt>
+    void insertRange(InputIt first, InputIt last, int, std::input_iterator_tag)
+    {
+        for (; first != last; ++first) _insert(*first);
+    }
+
+    template <class ForwardIt>
+    void insertRange(ForwardIt first, ForwardIt last, int, std::forward_iterator_tag)
+    {
+        int n = std::distance(first, last);
+        resize(nodeCount_ + n);
+        reserveNodes(alloc_, n);
+        for (; first != last; ++first) _insert(*first);
+    }
+
+    template <class RandomIt>
+    void insertRange(RandomIt first, RandomIt last, int threadCount, std::random_access_iterator_tag)
+    {
+        if (threadCount <= 1)
+            insertRange(first, last, threadCount, std::forward_iterator_tag());
+        else
+            parallelInsert(first, last - first, threadCount);
+    }
+
+    template <class RandomIt>
+    void parallelInsert(RandomIt first, int n, int threadCount);
+
+    // 在threadCount个线程上执行fn(线程编号)，当前线程执行编号0
+    template <class Func>
+    static void runParallel(int threadCount, Func fn)
+    {
+        std::vector<std::thread> threads;
+        for (int t = 1; t < threadCount; ++t) threads.emplace_back(fn, t);
+        fn(0);
+        for (auto& t : threads) t.join();
+    }
+
+    template <class... Args>
+    Node* createNode(Args&&... args)
+    {
+        Node* node = NodeAllocTraits::allocate(alloc_, 1);
+        NodeAllocTraits::construct(alloc_, node, std::forward<Args>(args)...);
+        return node;
+    }
+
+    void destroyNode(Node* node)
+    {
+        NodeAllocTraits::destroy(alloc_, node);
+        NodeAllocTraits::deallocate(alloc_, node, 1);
+    }
+
     void initBuckets(int size)
     {
         int newSize = roundup(size);
@@ -106,20 +354,89 @@ private:
         nodeCount_ = 0;
     }
 
-    const Node* _begin() const
+    const Node* _begin() const { return firstNode(0); }
+
+    // 从新桶数组的pos处开始找到第一个节点，新桶遍历完后继续遍历尚未迁移的旧桶
+    const Node* firstNode(int pos) const
     {
-        for (int i = 0; i < (int)buckets_.size(); ++i)
+        for (; pos < (int)buckets_.size(); ++pos)
+        {
+            if (buckets_[pos]) return buckets_[pos];
+        }
+        return firstOldNode(rehashPos_);
+    }
+
+    const Node* firstOldNode(int pos) const
+    {
+        for (; pos < (int)oldBuckets_.size(); ++pos)
         {
-            if (buckets_[i]) return buckets_[i];
+            if (oldBuckets_[pos]) return oldBuckets_[pos];
         }
         return nullptr;
     }
 
-    int bucketPos(const KeyType& key) const
-    { return bucketPos(key, buckets_.size()); }
+    // 链表末尾节点的下一个节点
+    const Node* nextBucketNode(const Node* node) const
+    {
+        size_t hash = nodeHash(node);
+        if (rehashing())
+        {
+            int oldPos = bucketPos(hash, oldBuckets_.size());
+            if (oldPos >= rehashPos_) return firstOldNode(oldPos + 1);
+        }
+        return firstNode(bucketPos(hash, buckets_.size()) + 1);
+    }
+
+    // 哈希值所在的桶：rehash期间，旧桶尚未迁移的元素仍在旧桶中
+    Node*& bucketOf(size_t hash)
+    {
+        if (rehashing())
+        {
+            int oldPos = bucketPos(hash, oldBuckets_.size());
+            if (oldPos >= rehashPos_) return oldBuckets_[oldPos];
+        }
+        return buckets_[bucketPos(hash, buckets_.size())];
+    }
+
+    Node* const& bucketOf(size_t hash) const
+    { return const_cast<HashTable*>(this)->bucketOf(hash); }
+
+    static int bucketPos(size_t hash, int n)
+    { return hash % n; }
+
+    // 节点的哈希值，启用缓存时直接读取
+    static size_t nodeHash(const Node* node)
+    { return nodeHash(node, CacheTag()); }
 
-    int bucketPos(const KeyType& key, int n) const
-    { return HashFunc()(key) % n; }
+    static size_t nodeHash(const Node* node, std::true_type)
+    { return node->hash; }
+
+    static size_t nodeHash(const Node* node, std::false_type)
+    { return hashCode(getKey(node->obj)); }
+
+    static void setHash(Node* node, size_t hash)
+    { setHash(node, hash, CacheTag()); }
+
+    static void setHash(Node* node, size_t hash, std::true_type)
+    { node->hash = hash; }
+
+    static void setHash(Node*, size_t, std::false_type) {}
+
+    static void copyHash(Node* dst, const Node* src, std::true_type)
+    { dst->hash = src->hash; }
+
+    static void copyHash(Node*, const Node*, std::false_type) {}
+
+    // 节点是否与key匹配，启用缓存时先比较哈希值
+    template <class K>
+    static bool matches(const Node* node, const K& key, size_t hash)
+    { return hashMatches(node, hash, CacheTag()) && key == getKey(node->obj); }
+
+    static bool hashMatches(const Node* node, size_t hash, std::true_type)
+    { return node->hash == hash; }
+
+    static bool hashMatches(const Node*, size_t, std::false_type)
+    { return true; }
 
     static int roundup(int n)
     { return roundupPowerOfTwo(n); }
@@ -157,21 +474,17 @@ private:
         bool operator!=(const Self& it) const { return node != it.node; }
 
         ObjectRef operator*() const { return node->obj; }
-        ObjectPtr operator->() const { return &*this; }
+        ObjectPtr operator->() const { return &node->obj; }
 
         Self& operator++()
         {
+            tab->markIterating();
             const Node* old = node;
             node = node->next;
             if (!node)
             {
                 // 根据元素值，定位出下一个bucket
-                int pos = tab->bucketPos(tab->getKey(old->obj)) + 1;
-                while (pos < (int)tab->buckets_.size() && !tab->buckets_[pos]) ++pos;
-                if (pos < (int)tab->buckets_.size())
-                {
-                    node = tab->buckets_[pos];
-                }
+                node = const_cast<NodePtr>(tab->nextBucketNode(old));
             }
             return *this;
         }
@@ -184,7 +497,7 @@ private:
         }
     };
 
-    struct Node
+    struct Node : HashCodeCache<CacheHash::value>
     {
         Node* next;
         Object obj;
@@ -193,95 +506,268 @@ private:
         Node(Object&& _obj): obj(std::move(_obj)) {}
     };
 
+    static constexpr int kRehashStep = 4; // 每次操作迁移的旧桶数
+    static constexpr int kBatchSize = 32; // 批量操作每轮处理的元素数
+
     std::vector<Node*> buckets_;
+    std::vector<Node*> oldBuckets_; // rehash期间的旧桶
     int nodeCount_;
+    int rehashPos_; // 下一个待迁移的旧桶
+    bool incremental_;
+    mutable std::atomic<bool> iterating_{false}; // 迁移期间已开始迭代
+    NodeAlloc alloc_;
+#ifdef HASH_TABLE_STATS
+    mutable HashProbeCounters counters_;
+#endif
 };
 
 
-template <class Object, class HashFunc, class ExtractKey>
-auto HashTable<Object, HashFunc, ExtractKey>::
-_find(const KeyType& key) const -> const Node*
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+template <class K>
+auto HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::
+_find(const K& key, size_t hash) const -> const Node*
 {
-    int pos = bucketPos(key); // 找到位置
-    const Node* cur = buckets_[pos];
+    const Node* cur = bucketOf(hash); // 找到位置
+#ifdef HASH_TABLE_STATS
+    int probes = 0;
+    while (cur)
+    {
+        ++probes;
+        if (matches(cur, key, hash)) break;
+        cur = cur->next;
+    }
+    counters_.recordFind(probes, cur != nullptr);
+    return cur;
+#else
     while (cur)
     {
-        if (key == getKey(cur->obj)) return cur;
+        if (matches(cur, key, hash)) return cur;
         cur = cur->next;
     }
     return nullptr;
+#endif
+}
+
+
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+constexpr int HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::kRehashStep;
+
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+constexpr int HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::kBatchSize;
+
+
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+void HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::
+walkChains(const Key* const* keys, const size_t* hashes, int n,
+           const Node** heads, const Node** out)
+{
+    int active[kBatchSize]; // 尚未结束的查找
+    int activeCount = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        out[i] = heads[i];
+        if (heads[i])
+        {
+            __builtin_prefetch(heads[i]);
+            active[activeCount++] = i;
+        }
+    }
+    // 每轮每条链表只前进一步，并预取下一个节点
+    while (activeCount > 0)
+    {
+        for (int j = 0; j < activeCount;)
+        {
+            int i = active[j];
+            const Node* cur = out[i];
+            if (matches(cur, *keys[i], hashes[i]) || !(cur = cur->next))
+            {
+                out[i] = cur; // 找到或到达链表末尾
+                active[j] = active[--activeCount];
+                continue;
+            }
+            out[i] = cur;
+            __builtin_prefetch(cur);
+            ++j;
+        }
+    }
+}
+
+
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+void HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::
+findBatch(const Key* keys, int n, ConstIterator* out) const
+{
+    const Key* keyPtrs[kBatchSize];
+    size_t hashes[kBatchSize];
+    const Node* const* slots[kBatchSize];
+    const Node* heads[kBatchSize];
+    const Node* found[kBatchSize];
+    for (int base = 0; base < n; base += kBatchSize)
+    {
+        int m = std::min(kBatchSize, n - base);
+        for (int i = 0; i < m; ++i)
+        {
+            keyPtrs[i] = &keys[base + i];
+            hashes[i] = hashCode(keys[base + i]);
+            slots[i] = &bucketOf(hashes[i]);
+            __builtin_prefetch(slots[i]);
+        }
+        for (int i = 0; i < m; ++i) heads[i] = *slots[i];
+        walkChains(keyPtrs, hashes, m, heads, found);
+        for (int i = 0; i < m; ++i) out[base + i] = ConstIterator(found[i], this);
+    }
+}
+
+
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+void HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::
+findBatch(const Key* keys, int n, Iterator* out)
+{
+    lookupRehashStep();
+    const HashTable* self = this;
+    ConstIterator res[kBatchSize];
+    for (int base = 0; base < n; base += kBatchSize)
+    {
+        int m = std::min(kBatchSize, n - base);
+        self->findBatch(keys + base, m, res);
+        for (int i = 0; i < m; ++i)
+        {
+            out[base + i] = Iterator(const_cast<Node*>(res[i].node), this);
+        }
+    }
+}
+
+
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+void HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::
+insertBatch(const Object* objs, int n, std::pair<Iterator, bool>* out)
+{
+    resize(nodeCount_ + n); // 只检查一次是否需要重建表格
+
+    const Key* keys[kBatchSize];
+    size_t hashes[kBatchSize];
+    Node** slots[kBatchSize];
+    const Node* heads[kBatchSize];
+    const Node* found[kBatchSize];
+    for (int base = 0; base < n; base += kBatchSize)
+    {
+        int m = std::min(kBatchSize, n - base);
+        for (int i = 0; i < m; ++i)
+        {
+            keys[i] = &getKey(objs[base + i]);
+            hashes[i] = hashCode(*keys[i]);
+            slots[i] = &bucketOf(hashes[i]);
+            __builtin_prefetch(slots[i]);
+        }
+        for (int i = 0; i < m; ++i) heads[i] = *slots[i];
+        walkChains(keys, hashes, m, heads, found);
+
+        for (int i = 0; i < m; ++i)
+        {
+            Node* node = const_cast<Node*>(found[i]);
+            if (!node)
+            {
+                // 本轮之前插入的节点位于链表头部，只需检查到原头节点为止
+                for (Node* cur = *slots[i]; cur != heads[i]; cur = cur->next)
+                {
+                    if (matches(cur, *keys[i], hashes[i]))
+                    {
+                        node = cur;
+                        break;
+                    }
+                }
+            }
+            bool inserted = !node;
+            if (inserted)
+            {
+                node = createNode(objs[base + i]);
+                setHash(node, hashes[i]);
+                node->next = *slots[i];
+                *slots[i] = node;
+                ++nodeCount_;
+            }
+            if (out) out[base + i] = {Iterator(node, this), inserted};
+        }
+    }
 }
 
 
-template <class Object, class HashFunc, class ExtractKey>
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
 template <class X>
-auto HashTable<Object, HashFunc, ExtractKey>::
+auto HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::
 _insert(X&& obj) -> std::pair<Iterator, bool>
 {
     resize(nodeCount_ + 1); // 检查是否需要重建表格
 
-    int pos = bucketPos(getKey(obj)); // 找到位置
-    Node* cur = buckets_[pos];
+    size_t hash = hashCode(getKey(obj));
+    Node*& first = bucketOf(hash); // 找到位置
+    Node* cur = first;
     while (cur)
     {
-        if (getKey(obj) == getKey(cur->obj))
+        if (matches(cur, getKey(obj), hash))
         {
             return {Iterator(cur, this), false};
         }
         cur = cur->next;
     }
-    Node* node = new Node(std::forward<X>(obj));
-    node->next = buckets_[pos];
-    buckets_[pos] = node;
+    Node* node = createNode(std::forward<X>(obj));
+    setHash(node, hash);
+    node->next = first;
+    first = node;
     ++nodeCount_;
     return {Iterator(node, this), true};
 }
 
 
-template <class Object, class HashFunc, class ExtractKey>
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
 template <class X>
-auto HashTable<Object, HashFunc, ExtractKey>::
+auto HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::
 _insertEqual(X&& obj) -> Iterator
 {
     resize(nodeCount_ + 1); // 检查是否需要重建表格
 
-    Node* node = new Node(std::forward<X>(obj));
-    int pos = bucketPos(getKey(obj)); // 找到位置
-    Node* cur = buckets_[pos];
+    Node* node = createNode(std::forward<X>(obj));
+    size_t hash = hashCode(getKey(node->obj));
+    setHash(node, hash);
+    Node*& first = bucketOf(hash); // 找到位置
+    Node* cur = first;
     while (cur)
     {
-        if (getKey(obj) == getKey(cur->obj))
+        if (matches(cur, getKey(node->obj), hash))
         {
             node->next = cur->next;
             cur->next = node;
             ++nodeCount_;
-            return node;
+            return Iterator(node, this);
         }
         cur = cur->next;
     }
-    node->next = buckets_[pos];
-    buckets_[pos] = node;
+    node->next = first;
+    first = node;
     ++nodeCount_;
     return Iterator(node, this);
 }
 
 
-template <class Object, class HashFunc, class ExtractKey>
-bool HashTable<Object, HashFunc, ExtractKey>::
-remove(const KeyType& key)
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+template <class K>
+bool HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::
+_remove(const K& key, size_t hash)
 {
-    int pos = bucketPos(key);
-    Node* cur = buckets_[pos];
+    lookupRehashStep();
+
+    Node*& first = bucketOf(hash);
+    Node* cur = first;
     Node* prev = nullptr;
     while (cur)
     {
-        if (key == getKey(cur->obj))
+        if (matches(cur, key, hash))
         {
             if (prev == nullptr)
-                buckets_[pos] = cur->next;
+                first = cur->next;
             else
                 prev->next = cur->next;
-            delete cur;
+            destroyNode(cur);
             --nodeCount_;
             return true;
         }
@@ -292,75 +778,258 @@ remove(const KeyType& key)
 }
 
 
-template <class Object, class HashFunc, class ExtractKey>
-void HashTable<Object, HashFunc, ExtractKey>::resize(int hintCnt)
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+void HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::resize(int hintCnt)
 {
+    iterating_.store(false, std::memory_order_relaxed); // 插入使迭代器失效
+    if (rehashing()) rehashStep();
     if (hintCnt <= (int)buckets_.size()) return;
+#ifdef HASH_TABLE_STATS
+    // 渐进式rehash只计入扩容时的这一步，之后分摊到各次操作的迁移不计入
+    auto start = std::chrono::steady_clock::now();
+#endif
+    // 上一轮迁移未完成又需扩容时，先完成上一轮
+    finishRehash();
+
     int newSize = roundup(hintCnt);
-    std::vector<Node*> tmp(newSize, nullptr);
+    oldBuckets_.swap(buckets_);
+    buckets_.assign(newSize, nullptr);
+    rehashPos_ = 0;
 
-    for (int i = 0; i < (int)buckets_.size(); ++i)
+    if (incremental_)
+        rehashStep();
+    else
+        finishRehash();
+#ifdef HASH_TABLE_STATS
+    counters_.recordResize(std::chrono::steady_clock::now() - start);
+#endif
+}
+
+
+#ifdef HASH_TABLE_STATS
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+HashTableStats HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::stats() const
+{
+    HashTableStats st;
+    st.size = nodeCount_;
+    st.bucketCount = buckets_.size() + oldBuckets_.size() - rehashPos_;
+    st.loadFactor = st.bucketCount ? (double)st.size / st.bucketCount : 0;
+    for (const Node* first : buckets_) addChainLength(st.chainLengths, first);
+    for (int i = rehashPos_; i < (int)oldBuckets_.size(); ++i)
+        addChainLength(st.chainLengths, oldBuckets_[i]);
+    counters_.fill(st);
+    st.bucketBytes = (buckets_.capacity() + oldBuckets_.capacity()) * sizeof(Node*);
+    st.nodeBytes = (size_t)nodeCount_ * sizeof(Node);
+    return st;
+}
+#endif
+
+
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+void HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::moveBucket(Node*& first)
+{
+    while (first)
+    {
+        Node* cur = first;
+        // 找到在新buckets中的位置
+        int newPos = bucketPos(nodeHash(cur), buckets_.size());
+        // 旧bucket指向下一个节点
+        first = cur->next;
+        // 当前节点插入到新bucket
+        cur->next = buckets_[newPos];
+        buckets_[newPos] = cur;
+    }
+}
+
+
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+void HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::rehashStep()
+{
+    int end = std::min(rehashPos_ + kRehashStep, (int)oldBuckets_.size());
+    for (; rehashPos_ < end; ++rehashPos_)
+    {
+        moveBucket(oldBuckets_[rehashPos_]);
+    }
+    if (rehashPos_ == (int)oldBuckets_.size())
+    {
+        std::vector<Node*>().swap(oldBuckets_);
+        rehashPos_ = 0;
+    }
+}
+
+
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+void HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::finishRehash()
+{
+    for (; rehashPos_ < (int)oldBuckets_.size(); ++rehashPos_)
+    {
+        moveBucket(oldBuckets_[rehashPos_]);
+    }
+    std::vector<Node*>().swap(oldBuckets_);
+    rehashPos_ = 0;
+}
+
+
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+void HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::clear()
+{
+    finishRehash();
+    // 分配器支持整体释放时只需析构元素，元素可平凡析构时连遍历都可省去
+    const bool bulk = HasBulkRelease<NodeAlloc>::value;
+    if (!bulk || !std::is_trivially_destructible<Object>::value)
     {
-        Node* first = buckets_[i];
-        while (first)
+        for (int i = 0; i < (int)buckets_.size(); ++i)
         {
-            // 找到在新buckets中的位置
-            int newPos = bucketPos(getKey(first->obj), newSize);
-            // 旧bucket指向下一个节点
-            buckets_[i] = first->next;
-            // 当前节点插入到新bucket
-            first->next = tmp[newPos];
-            tmp[newPos] = first;
-            // 准备处理旧bucket的下一个节点
-            first = buckets_[i];
+            Node* cur = buckets_[i];
+            while (cur)
+            {
+                Node* next = cur->next;
+                if (bulk)
+                    NodeAllocTraits::destroy(alloc_, cur);
+                else
+                    destroyNode(cur);
+                cur = next;
+            }
         }
     }
-    buckets_.swap(tmp);
+    bulkRelease(alloc_);
+    std::fill(buckets_.begin(), buckets_.end(), nullptr); // 保留桶数组，清空后仍可查找
+    nodeCount_ = 0;
 }
 
 
-template <class Object, class HashFunc, class ExtractKey>
-void HashTable<Object, HashFunc, ExtractKey>::clear()
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::
+HashTable(const HashTable& rhs)
+    : nodeCount_(rhs.nodeCount_),
+      rehashPos_(rhs.rehashPos_),
+      incremental_(rhs.incremental_),
+      alloc_(NodeAllocTraits::select_on_container_copy_construction(rhs.alloc_))
+{
+    copyBuckets(buckets_, rhs.buckets_);
+    copyBuckets(oldBuckets_, rhs.oldBuckets_);
+};
+
+
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+template <class RandomIt>
+void HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::
+parallelInsert(RandomIt first, int n, int threadCount)
 {
-    for (int i = 0; i < (int)buckets_.size(); ++i)
+    resize(nodeCount_ + n);
+    finishRehash();
+    const int bucketCount = buckets_.size();
+    threadCount = std::max(1, std::min({threadCount, n, bucketCount}));
+    const int T = threadCount;
+
+    // 线程t负责的桶区间为[t * bucketCount / T, (t + 1) * bucketCount / T)
+    auto ownerOf = [bucketCount, T](size_t hash)
+    { return (int)((long long)bucketPos(hash, bucketCount) * T / bucketCount); };
+    auto chunkBegin = [n, T](int t) { return (int)((long long)n * t / T); };
+
+    // 1. 输入均分为T段，并行计算哈希值，统计每段中交给各线程的元素数
+    std::vector<size_t> hashes(n);
+    std::vector<int> counts(T * T, 0); // counts[段 * T + 线程]
+    runParallel(T, [&](int t)
+    {
+        std::vector<int> local(T, 0); // 先在线程内计数，避免伪共享
+        for (int i = chunkBegin(t); i < chunkBegin(t + 1); ++i)
+        {
+            const Object& obj = first[i];
+            hashes[i] = hashCode(getKey(obj));
+            ++local[ownerOf(hashes[i])];
+        }
+        std::copy(local.begin(), local.end(), counts.begin() + t * T);
+    });
+
+    // 2. 按（线程, 段）的顺序求前缀和，保持同一线程内元素的输入顺序
+    std::vector<int> offsets(T * T);
+    std::vector<int> ownerBegin(T + 1, 0);
+    int sum = 0;
+    for (int owner = 0; owner < T; ++owner)
     {
-        Node* cur = buckets_[i];
-        while (cur)
+        ownerBegin[owner] = sum;
+        for (int chunk = 0; chunk < T; ++chunk)
         {
-            Node* next = cur->next;
-            delete cur;
-            cur = next;
+            offsets[chunk * T + owner] = sum;
+            sum += counts[chunk * T + owner];
         }
-        buckets_[i] = nullptr;
     }
-    buckets_.clear();
-    nodeCount_ = 0;
+    ownerBegin[T] = sum;
+
+    // 3. 并行分发元素下标
+    std::vector<int> order(n);
+    runParallel(T, [&](int t)
+    {
+        std::vector<int> next(offsets.begin() + t * T, offsets.begin() + (t + 1) * T);
+        for (int i = chunkBegin(t); i < chunkBegin(t + 1); ++i)
+            order[next[ownerOf(hashes[i])]++] = i;
+    });
+
+    // 4. 分配器不是线程安全的，由当前线程预先分配所有节点
+    reserveNodes(alloc_, n);
+    std::vector<Node*> nodes(n);
+    for (auto& node : nodes) node = NodeAllocTraits::allocate(alloc_, 1);
+
+    // 5. 各线程插入自己负责的桶，重复的元素留下未使用的节点
+    std::vector<char> used(n, 0);
+    std::vector<int> inserted(T, 0);
+    runParallel(T, [&](int t)
+    {
+        int count = 0;
+        for (int k = ownerBegin[t]; k < ownerBegin[t + 1]; ++k)
+        {
+            int i = order[k];
+            const Object& obj = first[i];
+            Node*& head = buckets_[bucketPos(hashes[i], bucketCount)];
+            const Node* cur = head;
+            while (cur && !matches(cur, getKey(obj), hashes[i])) cur = cur->next;
+            if (cur) continue;
+
+            Node* node = nodes[i];
+            NodeAllocTraits::construct(alloc_, node, obj);
+            setHash(node, hashes[i]);
+            node->next = head;
+            head = node;
+            used[i] = 1;
+            ++count;
+        }
+        inserted[t] = count;
+    });
+
+    for (int i = 0; i < n; ++i)
+    {
+        if (!used[i]) NodeAllocTraits::deallocate(alloc_, nodes[i], 1);
+    }
+    for (int count : inserted) nodeCount_ += count;
 }
 
 
-template <class Object, class HashFunc, class ExtractKey>
-HashTable<Object, HashFunc, ExtractKey>::
-HashTable(const HashTable& rhs): nodeCount_(rhs.nodeCount_)
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class CacheHash>
+void HashTable<Object, HashFunc, ExtractKey, Alloc, CacheHash>::
+copyBuckets(std::vector<Node*>& dst, const std::vector<Node*>& src)
 {
-    buckets_.resize(rhs.buckets_.size());
-    for (int i = 0; i < (int)rhs.buckets_.size(); ++i)
+    dst.assign(src.size(), nullptr);
+    for (int i = 0; i < (int)src.size(); ++i)
     {
-        if (rhs.buckets_[i])
+        if (src[i])
         {
-            const Node* cur = rhs.buckets_[i];
-            Node* copy = new Node(cur->obj);
-            buckets_[i] = copy;
+            const Node* cur = src[i];
+            Node* copy = createNode(cur->obj);
+            copyHash(copy, cur, CacheTag());
+            dst[i] = copy;
 
             while (cur->next)
             {
-                copy->next = new Node(cur->next->obj);
+                copy->next = createNode(cur->next->obj);
                 cur = cur->next;
                 copy = copy->next;
+                copyHash(copy, cur, CacheTag());
             }
             copy->next = nullptr;
         }
     }
-};
+}
 
 
 #endif //HASH_TABLE_HPP
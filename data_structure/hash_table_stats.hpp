@@ -0,0 +1,163 @@
+#ifndef HASH_TABLE_STATS_HPP
+#define HASH_TABLE_STATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+// 哈希表统计信息
+// 编译时定义HASH_TABLE_STATS宏后，HashTable和LinkedHashTable记录查找的探测次数和扩容耗时，
+// 并提供stats()和resetStats()；未定义时相关代码全部编译去除
+struct HashTableStats
+{
+    int size = 0;
+    int bucketCount = 0;
+    double loadFactor = 0;
+    std::vector<int> chainLengths; // chainLengths[i]为长度为i的链表个数
+
+    // 探测次数：查找时比较过的节点数（不含批量查找）
+    long hits = 0;
+    double avgHitProbes = 0;
+    int maxHitProbes = 0;
+    long misses = 0;
+    double avgMissProbes = 0;
+    int maxMissProbes = 0;
+
+    long resizes = 0;
+    double resizeMillis = 0; // 扩容的总耗时
+
+    size_t bucketBytes = 0;
+    size_t nodeBytes = 0;
+
+    void dumpText(std::ostream& os) const
+    {
+        os << "size: " << size << ", buckets: " << bucketCount
+           << ", load factor: " << loadFactor << "\n";
+        os << "chain length histogram:\n";
+        for (int i = 0; i < (int)chainLengths.size(); ++i)
+        {
+            if (chainLengths[i] > 0) os << "  " << i << ": " << chainLengths[i] << "\n";
+        }
+        os << "successful find: " << hits << ", avg probes " << avgHitProbes
+           << ", max probes " << maxHitProbes << "\n";
+        os << "unsuccessful find: " << misses << ", avg probes " << avgMissProbes
+           << ", max probes " << maxMissProbes << "\n";
+        os << "resizes: " << resizes << ", total " << resizeMillis << " ms\n";
+        os << "memory: buckets " << bucketBytes << " bytes, nodes " << nodeBytes << " bytes\n";
+    }
+
+    void dumpJson(std::ostream& os) const
+    {
+        os << "{\"size\":" << size << ",\"bucketCount\":" << bucketCount
+           << ",\"loadFactor\":" << loadFactor << ",\"chainLengths\":[";
+        for (int i = 0; i < (int)chainLengths.size(); ++i)
+        {
+            if (i > 0) os << ",";
+            os << chainLengths[i];
+        }
+        os << "],\"hits\":" << hits << ",\"avgHitProbes\":" << avgHitProbes
+           << ",\"maxHitProbes\":" << maxHitProbes
+           << ",\"misses\":" << misses << ",\"avgMissProbes\":" << avgMissProbes
+           << ",\"maxMissProbes\":" << maxMissProbes
+           << ",\"resizes\":" << resizes << ",\"resizeMillis\":" << resizeMillis
+           << ",\"bucketBytes\":" << bucketBytes << ",\"nodeBytes\":" << nodeBytes << "}";
+    }
+};
+
+
+// 哈希表内部的计数器
+// const查找也要计数，且可能在读锁下并发执行，因此使用relaxed原子变量
+class HashProbeCounters
+{
+public:
+    HashProbeCounters() { reset(); }
+
+    HashProbeCounters(const HashProbeCounters& rhs) { *this = rhs; }
+
+    HashProbeCounters& operator=(const HashProbeCounters& rhs)
+    {
+        hits_.store(rhs.hits_.load(kOrder), kOrder);
+        hitProbes_.store(rhs.hitProbes_.load(kOrder), kOrder);
+        maxHitProbes_.store(rhs.maxHitProbes_.load(kOrder), kOrder);
+        misses_.store(rhs.misses_.load(kOrder), kOrder);
+        missProbes_.store(rhs.missProbes_.load(kOrder), kOrder);
+        maxMissProbes_.store(rhs.maxMissProbes_.load(kOrder), kOrder);
+        resizes_.store(rhs.resizes_.load(kOrder), kOrder);
+        resizeNanos_.store(rhs.resizeNanos_.load(kOrder), kOrder);
+        return *this;
+    }
+
+    void recordFind(int probes, bool found)
+    {
+        if (found)
+        {
+            hits_.fetch_add(1, kOrder);
+            hitProbes_.fetch_add(probes, kOrder);
+            updateMax(maxHitProbes_, probes);
+        }
+        else
+        {
+            misses_.fetch_add(1, kOrder);
+            missProbes_.fetch_add(probes, kOrder);
+            updateMax(maxMissProbes_, probes);
+        }
+    }
+
+    void recordResize(std::chrono::steady_clock::duration time)
+    {
+        resizes_.fetch_add(1, kOrder);
+        resizeNanos_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count(), kOrder);
+    }
+
+    void reset()
+    {
+        hits_ = hitProbes_ = misses_ = missProbes_ = resizes_ = resizeNanos_ = 0;
+        maxHitProbes_ = maxMissProbes_ = 0;
+    }
+
+    // 填写探测和扩容相关的字段
+    void fill(HashTableStats& st) const
+    {
+        st.hits = hits_.load(kOrder);
+        st.avgHitProbes = st.hits ? (double)hitProbes_.load(kOrder) / st.hits : 0;
+        st.maxHitProbes = maxHitProbes_.load(kOrder);
+        st.misses = misses_.load(kOrder);
+        st.avgMissProbes = st.misses ? (double)missProbes_.load(kOrder) / st.misses : 0;
+        st.maxMissProbes = maxMissProbes_.load(kOrder);
+        st.resizes = resizes_.load(kOrder);
+        st.resizeMillis = resizeNanos_.load(kOrder) / 1e6;
+    }
+
+private:
+    static constexpr std::memory_order kOrder = std::memory_order_relaxed;
+
+    static void updateMax(std::atomic<int>& max, int value)
+    {
+        int cur = max.load(kOrder);
+        while (value > cur && !max.compare_exchange_weak(cur, value, kOrder)) {}
+    }
+
+    std::atomic<long> hits_;
+    std::atomic<long> hitProbes_;
+    std::atomic<int> maxHitProbes_;
+    std::atomic<long> misses_;
+    std::atomic<long> missProbes_;
+    std::atomic<int> maxMissProbes_;
+    std::atomic<long> resizes_;
+    std::atomic<long> resizeNanos_;
+};
+
+
+// 统计一条链表的长度，计入直方图
+template <class NodePtr>
+inline void addChainLength(std::vector<int>& hist, NodePtr first)
+{
+    int len = 0;
+    for (; first; first = first->next) ++len;
+    if (len >= (int)hist.size()) hist.resize(len + 1, 0);
+    ++hist[len];
+}
+
+
+#endif // HASH_TABLE_STATS_HPP
@@ -1,7 +1,9 @@
 
 #include "linked_hash_table.hpp"
 
-template <class Key, class Value, class HashFunc = std::hash<Key>>
+// ClockBit、Expiry：同LinkedHashTable，分别启用CLOCK淘汰和存活时间
+template <class Key, class Value, class HashFunc = std::hash<Key>,
+          class ClockBit = std::false_type, class Expiry = std::false_type>
 class LinkedHashMap
 {
 public:
@@ -14,17 +16,24 @@ public:
     };
 
     using Object = std::pair<const Key, Value>;
-    using Container = LinkedHashTable<Object, HashFunc, select1st<Object>>;
+    using Container = LinkedHashTable<Object, HashFunc, select1st<Object>,
+                                      std::allocator<Object>, ClockBit, Expiry>;
     using Iterator = typename Container::Iterator;
     using ConstIterator = typename Container::ConstIterator;
     using KeyType = typename Container::KeyType;
     using RemoveCallback = typename Container::RemoveCallback;
+    using TimePoint = typename Container::TimePoint;
+    using Duration = typename Container::Duration;
 
     LinkedHashMap(int n = 32): table_(n) {}
 
     void setRemoveCallback(const RemoveCallback& cb)
     { table_.setRemoveCallback(cb); }
 
+    // 淘汰策略，CLOCK模式下查找不修改链表，需要ClockBit为std::true_type
+    void setEvictionPolicy(EvictionPolicy policy)
+    { table_.setEvictionPolicy(policy); }
+
     // 插入
     std::pair<Iterator, bool> insert(const Object& obj)
     { return table_.insert(obj); }
@@ -32,6 +41,14 @@ public:
     std::pair<Iterator, bool> insert(Object&& obj)
     { return table_.insert(std::move(obj)); }
 
+    // 插入并设置存活时间，过期的元素在find时惰性删除，或由expire()分批删除，
+    // 需要Expiry为std::true_type
+    std::pair<Iterator, bool> insert(const Object& obj, Duration ttl)
+    { return table_.insert(obj, ttl); }
+
+    std::pair<Iterator, bool> insert(Object&& obj, Duration ttl)
+    { return table_.insert(std::move(obj), ttl); }
+
     // 查找
     Iterator find(const KeyType& key) {return table_.find(key);}
     ConstIterator find(const KeyType& key) const {return table_.find(key);}
@@ -42,6 +59,10 @@ public:
     // 删除
     Iterator erase(Iterator it) { return table_.erase(it); }
     void removeFirst() { table_.removeFirst(); }
+    void evict() { table_.evict(); }
+
+    // 删除最多budget个已过期的元素，返回删除的个数
+    int expire(TimePoint now, int budget) { return table_.expire(now, budget); }
     bool remove(const KeyType& key) { return table_.remove(key); }
 
     void clear() { table_.clear(); }
@@ -90,6 +111,56 @@ int main()
     for (const auto& x : map) cout << x.second << " ";
     cout << endl;
 
+    // CLOCK淘汰：被访问过的元素获得第二次机会
+    using ClockMap = LinkedHashMap<int, int, hash<int>, true_type>;
+    ClockMap clock;
+    clock.setEvictionPolicy(EvictionPolicy::CLOCK);
+    clock.setRemoveCallback([&clock] { return clock.size() > 3; });
+    clock.insert({1, 10});
+    clock.insert({2, 20});
+    clock.insert({3, 30});
+    clock.find(1);
+    ClockMap clockCopy = clock; // 拷贝保留访问位
+    clockCopy.setRemoveCallback([&clockCopy] { return clockCopy.size() > 3; });
+    clock.insert({4, 40}); // 1被访问过，淘汰2
+    clockCopy.insert({4, 40});
+
+    for (const auto& x : clock) cout << x.first << " ";
+    cout << endl;
+    for (const auto& x : clockCopy) cout << x.first << " ";
+    cout << endl;
+
+    // 所有元素的访问位都已设置时，淘汰的不能是刚插入的元素
+    ClockMap allHot;
+    allHot.setEvictionPolicy(EvictionPolicy::CLOCK);
+    allHot.setRemoveCallback([&allHot] { return allHot.size() > 3; });
+    for (int i = 1; i <= 3; ++i) allHot.insert({i, i * 10});
+    for (int i = 1; i <= 3; ++i) allHot.find(i);
+    auto inserted = allHot.insert({4, 40});
+    cout << inserted.first->second << " " << allHot.size() << " "
+         << (allHot.find(4) != allHot.end()) << endl;
+
+    // operator[]命中时同样设置访问位
+    ClockMap indexed;
+    indexed.setEvictionPolicy(EvictionPolicy::CLOCK);
+    indexed.setRemoveCallback([&indexed] { return indexed.size() > 3; });
+    for (int i = 1; i <= 3; ++i) indexed.insert({i, i * 10});
+    indexed[1] += 1;
+    indexed.insert({4, 40}); // 1被访问过，淘汰2
+    for (const auto& x : indexed) cout << x.first << " ";
+    cout << endl;
+
+    // 存活时间
+    using namespace std::chrono;
+    using SessionMap = LinkedHashMap<int, int, hash<int>, false_type, true_type>;
+    SessionMap sessions;
+    for (int i = 0; i < 5; ++i) sessions.insert({i, i}, seconds(i < 3 ? 0 : 60));
+    cout << (sessions.find(0) != sessions.end()) << " " << sessions.size() << endl;
+    SessionMap sessionsCopy = sessions; // 拷贝保留过期时间
+    cout << sessionsCopy.expire(steady_clock::now(), 10) << " " << sessionsCopy.size() << endl;
+    cout << sessions.expire(steady_clock::now(), 1) << " " << sessions.size() << endl;
+    cout << sessions.expire(steady_clock::now(), 10) << " " << sessions.size() << endl;
+
     return 0;
 }
 
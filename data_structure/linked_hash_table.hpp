@@ -2,17 +2,65 @@
 #define LINKED_HASH_TABLE_HPP
 
 #include <assert.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <functional>
+#include <memory>
 #include <vector>
 
+#include "node_pool.hpp"
+
+#ifdef HASH_TABLE_STATS
+#include "hash_table_stats.hpp"
+#endif
+
+// 淘汰策略
+// FIFO：淘汰链表头部的节点
+// CLOCK：命中时只设置节点的访问位，淘汰时指针沿链表扫描，
+//        跳过并清除访问位已设置的节点，淘汰第一个未被访问的节点
+enum class EvictionPolicy { FIFO, CLOCK };
+
+// 节点中CLOCK模式的访问位
+template <bool Enable>
+struct ClockReferenceBit
+{
+    mutable std::atomic<bool> referenced{false};
+};
+
+template <>
+struct ClockReferenceBit<false> {};
+
+// 节点的过期时间
+template <bool Enable>
+struct ExpireTimeField
+{
+    std::chrono::steady_clock::time_point expireAt = std::chrono::steady_clock::time_point::max();
+};
+
+template <>
+struct ExpireTimeField<false> {};
+
+
 // 哈希表和双向循环链表结合
+// Alloc：节点分配器，可使用NodePool复用节点内存
+// ClockBit：为std::true_type时节点带访问位，才能使用CLOCK淘汰策略
+// Expiry：为std::true_type时节点带过期时间，才能使用带存活时间的insert
+// 两者默认关闭，FIFO/LRU用法的节点不为它们多占空间
 template <class Object, class HashFunc = std::hash<Object>,
-          class ExtractKey = std::_Identity<Object>>
+          class ExtractKey = std::_Identity<Object>,
+          class Alloc = std::allocator<Object>,
+          class ClockBit = std::false_type,
+          class Expiry = std::false_type>
 class LinkedHashTable
 {
     template <class NodePtr> struct IteratorT;
     struct Node;
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
+    using ClockTag = std::integral_constant<bool, ClockBit::value>;
+    using ExpiryTag = std::integral_constant<bool, Expiry::value>;
 public:
     using Iterator = IteratorT<Node*>;
     using ConstIterator = IteratorT<const Node*>;
@@ -20,23 +68,35 @@ public:
 
     using RemoveCallback = std::function<bool()>;
 
-    LinkedHashTable(int n = 32): nodeCount_(0)
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Duration = Clock::duration;
+
+    LinkedHashTable(int n = 32): nodeCount_(0), policy_(EvictionPolicy::FIFO)
     {
         buckets_.resize(roundup(n));
         head_ = (Node*)::malloc(sizeof(Node));
         head_->after = head_;
         head_->before = head_;
+        hand_ = head_;
     }
 
     ~LinkedHashTable() { clear(); ::free(head_); }
 
-    // 拷贝构造函数
+    // 拷贝构造函数，保留过期时间、CLOCK访问位和指针位置
     LinkedHashTable(const LinkedHashTable& rhs)
         : LinkedHashTable(rhs.buckets_.size())
     {
-        for (const auto& x : rhs) _insert(bucketPos(getKey(x)), x);
+        for (const Node* cur = rhs.head_->after; cur != rhs.head_; cur = cur->after)
+        {
+            Node* node = _insert(bucketPos(getKey(cur->obj)), cur->obj);
+            setReferenced(node, isReferenced(cur));
+            setExpireTime(node, nodeExpireTime(cur));
+            if (cur == rhs.hand_) hand_ = node;
+        }
         nodeCount_ = rhs.nodeCount_;
         removeCallback_ = rhs.removeCallback_;
+        policy_ = rhs.policy_;
     }
 
     // 移动构造函数
@@ -67,13 +127,24 @@ public:
         using std::swap;
         buckets_.swap(rhs.buckets_);
         swap(head_, rhs.head_);
+        swap(hand_, rhs.hand_);
         swap(nodeCount_, rhs.nodeCount_);
         swap(removeCallback_, rhs.removeCallback_);
+        swap(policy_, rhs.policy_);
+        swap(alloc_, rhs.alloc_);
     }
 
     void setRemoveCallback(const RemoveCallback& cb)
     { removeCallback_ = cb; }
 
+    // removeCallback_返回true时按该策略淘汰，CLOCK需要ClockBit为std::true_type
+    void setEvictionPolicy(EvictionPolicy policy)
+    {
+        assert(policy == EvictionPolicy::FIFO || ClockBit::value);
+        policy_ = policy;
+    }
+    EvictionPolicy evictionPolicy() const { return policy_; }
+
     // 插入
     std::pair<Iterator, bool> insert(const Object& obj)
     { return _insert(obj); }
@@ -81,22 +152,64 @@ public:
     std::pair<Iterator, bool> insert(Object&& obj)
     { return _insert(std::move(obj)); }
 
-    // 查找
+    // 插入并设置存活时间，key已存在时不修改
+    std::pair<Iterator, bool> insert(const Object& obj, Duration ttl)
+    { return setTTL(_insert(obj), ttl); }
+
+    std::pair<Iterator, bool> insert(Object&& obj, Duration ttl)
+    { return setTTL(_insert(std::move(obj)), ttl); }
+
+    // 过期时间，未设置存活时间时为TimePoint::max()
+    TimePoint expireTime(ConstIterator it) const
+    {
+        static_assert(Expiry::value, "expireTime requires Expiry = std::true_type");
+        return nodeExpireTime(it.node);
+    }
+
+    // 查找，已过期的元素视为不存在（非const版本同时将其删除）
+    // CLOCK模式下命中只设置访问位（原子变量），不修改链表，
+    // 外部可用读写锁的读锁保护并发查找
     ConstIterator find(const KeyType& key) const
-    { return _find(key); }
+    {
+        const Node* node = _find(key);
+        if (node != head_ && expired(node)) return head_;
+        return touch(node);
+    }
 
     Iterator find(const KeyType& key)
-    { return const_cast<Node*>(_find(key)); }
+    {
+        Node* node = const_cast<Node*>(_find(key));
+        if (node != head_ && expired(node))
+        {
+            erase(node);
+            return end();
+        }
+        return const_cast<Node*>(touch(node));
+    }
 
-    // 查找（未找到则插入）
+    // 查找（未找到则插入），命中时与find一样设置访问位
     Object& findOrInsert(const Object& obj)
-    { return *insert(obj).first; }
+    { return touchFound(insert(obj)); }
 
     Object& findOrInsert(Object&& obj)
-    { return *insert(std::move(obj)).first; }
+    { return touchFound(insert(std::move(obj))); }
+
+    // 将节点移到链表末尾，O(1)，用于实现LRU
+    void moveToLast(Iterator it)
+    {
+        Node* node = it.node;
+        if (node == head_->before) return;
+        unlink(node);
+        node->after = head_;
+        node->before = head_->before;
+        head_->before->after = node;
+        head_->before = node;
+    }
 
     // 删除
     void removeFirst() { erase(begin()); }
+    void evict() { evict(nullptr); }
+    int expire(TimePoint now, int budget);
     Iterator erase(Iterator it);
     bool remove(const KeyType& key);
 
@@ -111,10 +224,87 @@ public:
     ConstIterator end() const { return head_; }
     Iterator end() { return head_; }
 
+#ifdef HASH_TABLE_STATS
+    // 统计信息，链表长度直方图在调用时遍历所有桶得到
+    HashTableStats stats() const
+    {
+        HashTableStats st;
+        st.size = nodeCount_;
+        st.bucketCount = buckets_.size();
+        st.loadFactor = st.bucketCount ? (double)st.size / st.bucketCount : 0;
+        for (const Node* first : buckets_) addChainLength(st.chainLengths, first);
+        counters_.fill(st);
+        st.bucketBytes = buckets_.capacity() * sizeof(Node*);
+        st.nodeBytes = (size_t)nodeCount_ * sizeof(Node);
+        return st;
+    }
+
+    void resetStats() { counters_.reset(); }
+#endif
+
 private:
 
     const Node* _find(const KeyType& key) const;
 
+    // CLOCK模式下设置访问位，已设置时不再写入，避免无谓地使缓存行失效
+    const Node* touch(const Node* node) const
+    {
+        if (policy_ == EvictionPolicy::CLOCK && node != head_ && !isReferenced(node))
+            setReferenced(node, true);
+        return node;
+    }
+
+    bool expired(const Node* node) const
+    {
+        TimePoint expireAt = nodeExpireTime(node);
+        return expireAt != TimePoint::max() && expireAt <= Clock::now();
+    }
+
+    // 未启用的字段读出默认值，写入为空操作
+    static bool isReferenced(const Node* node) { return isReferenced(node, ClockTag()); }
+    static bool isReferenced(const Node* node, std::true_type)
+    { return node->referenced.load(std::memory_order_relaxed); }
+    static bool isReferenced(const Node*, std::false_type) { return false; }
+
+    static void setReferenced(const Node* node, bool referenced)
+    { setReferenced(node, referenced, ClockTag()); }
+    static void setReferenced(const Node* node, bool referenced, std::true_type)
+    { node->referenced.store(referenced, std::memory_order_relaxed); }
+    static void setReferenced(const Node*, bool, std::false_type) {}
+
+    static TimePoint nodeExpireTime(const Node* node) { return nodeExpireTime(node, ExpiryTag()); }
+    static TimePoint nodeExpireTime(const Node* node, std::true_type) { return node->expireAt; }
+    static TimePoint nodeExpireTime(const Node*, std::false_type) { return TimePoint::max(); }
+
+    static void setExpireTime(Node* node, TimePoint t) { setExpireTime(node, t, ExpiryTag()); }
+    static void setExpireTime(Node* node, TimePoint t, std::true_type) { node->expireAt = t; }
+    static void setExpireTime(Node*, TimePoint, std::false_type) {}
+
+    // 插入时key已存在，视为命中
+    Object& touchFound(std::pair<Iterator, bool> res)
+    {
+        if (!res.second) touch(res.first.node);
+        return *res.first;
+    }
+
+    // 淘汰一个节点，不淘汰keep（刚插入的节点）
+    void evict(const Node* keep);
+
+    std::pair<Iterator, bool> setTTL(std::pair<Iterator, bool> res, Duration ttl)
+    {
+        static_assert(Expiry::value, "insert with ttl requires Expiry = std::true_type");
+        if (res.second) setExpireTime(res.first.node, Clock::now() + ttl);
+        return res;
+    }
+
+    // 从链表中摘除节点，淘汰指针指向该节点时后移
+    void unlink(Node* node)
+    {
+        if (node == hand_) hand_ = node->after;
+        node->before->after = node->after;
+        node->after->before = node->before;
+    }
+
     template <class X>
     std::pair<Iterator, bool> _insert(X&& obj);
 
@@ -146,6 +336,20 @@ private:
 
     void resize(int hintCnt);
 
+    template <class... Args>
+    Node* createNode(Args&&... args)
+    {
+        Node* node = NodeAllocTraits::allocate(alloc_, 1);
+        NodeAllocTraits::construct(alloc_, node, std::forward<Args>(args)...);
+        return node;
+    }
+
+    void destroyNode(Node* node)
+    {
+        NodeAllocTraits::destroy(alloc_, node);
+        NodeAllocTraits::deallocate(alloc_, node, 1);
+    }
+
     // 迭代器
     template <class NodePtr>
     struct IteratorT
@@ -163,7 +367,7 @@ private:
         bool operator!=(const Self& it) const { return node != it.node; }
 
         ObjectRef operator*() const { return node->obj; }
-        ObjectPtr operator->() const { return &*this; }
+        ObjectPtr operator->() const { return &node->obj; }
 
         Self& operator++() { node = node->after; return *this; }
         Self operator++(int)
@@ -182,7 +386,7 @@ private:
         }
     };
 
-    struct Node
+    struct Node : ClockReferenceBit<ClockBit::value>, ExpireTimeField<Expiry::value>
     {
         Object obj;
         Node* next;
@@ -195,32 +399,50 @@ private:
 
     std::vector<Node*> buckets_; // 桶
     Node* head_; // 头结点
+    Node* hand_; // CLOCK模式的淘汰指针，指向头结点时从链表头部开始
     int nodeCount_;
     RemoveCallback removeCallback_;
+    EvictionPolicy policy_;
+    NodeAlloc alloc_;
+#ifdef HASH_TABLE_STATS
+    mutable HashProbeCounters counters_;
+#endif
 };
 
 
-template <class Object, class HashFunc, class ExtractKey>
-auto LinkedHashTable<Object, HashFunc, ExtractKey>::
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class ClockBit, class Expiry>
+auto LinkedHashTable<Object, HashFunc, ExtractKey, Alloc, ClockBit, Expiry>::
 _find(const KeyType& key) const -> const Node*
 {
     int pos = bucketPos(key); // 找到位置
     const Node* cur = buckets_[pos];
+#ifdef HASH_TABLE_STATS
+    int probes = 0;
+    while (cur)
+    {
+        ++probes;
+        if (key == getKey(cur->obj)) break;
+        cur = cur->next;
+    }
+    counters_.recordFind(probes, cur != nullptr);
+    return cur ? cur : head_;
+#else
     while (cur)
     {
         if (key == getKey(cur->obj)) return cur;
         cur = cur->next;
     }
     return head_;
+#endif
 }
 
 
-template <class Object, class HashFunc, class ExtractKey>
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class ClockBit, class Expiry>
 template <class X>
-inline auto LinkedHashTable<Object, HashFunc, ExtractKey>::
+inline auto LinkedHashTable<Object, HashFunc, ExtractKey, Alloc, ClockBit, Expiry>::
 _insert(int pos, X&& obj) -> Node*
 {
-    Node* node = new Node(std::forward<X>(obj));
+    Node* node = createNode(std::forward<X>(obj));
     node->next = buckets_[pos];
     buckets_[pos] = node;
 
@@ -231,9 +453,9 @@ _insert(int pos, X&& obj) -> Node*
     return node;
 }
 
-template <class Object, class HashFunc, class ExtractKey>
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class ClockBit, class Expiry>
 template <class X>
-auto LinkedHashTable<Object, HashFunc, ExtractKey>::
+auto LinkedHashTable<Object, HashFunc, ExtractKey, Alloc, ClockBit, Expiry>::
 _insert(X&& obj) -> std::pair<Iterator, bool>
 {
     resize(nodeCount_ + 1); // 检查是否需要重建表格
@@ -244,19 +466,21 @@ _insert(X&& obj) -> std::pair<Iterator, bool>
     {
         if (getKey(obj) == getKey(cur->obj))
         {
-            return {cur, false};
+            if (!expired(cur)) return {cur, false};
+            erase(cur); // 已过期，用新元素替换
+            break;
         }
         cur = cur->next;
     }
     Node* node = _insert(pos, std::forward<X>(obj));
     ++nodeCount_;
-    if (removeCallback_ && removeCallback_()) removeFirst();
+    if (removeCallback_ && removeCallback_()) evict(node);
     return {node, true};
 }
 
 
-template <class Object, class HashFunc, class ExtractKey>
-bool LinkedHashTable<Object, HashFunc, ExtractKey>::
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class ClockBit, class Expiry>
+bool LinkedHashTable<Object, HashFunc, ExtractKey, Alloc, ClockBit, Expiry>::
 remove(const KeyType& key)
 {
     int pos = bucketPos(key); // 找到位置
@@ -271,9 +495,8 @@ remove(const KeyType& key)
             else
                 prev->next = cur->next;
                 
-            cur->before->after = cur->after;
-            cur->after->before = cur->before;
-            delete cur;
+            unlink(cur);
+            destroyNode(cur);
             --nodeCount_;
             return true;
         }
@@ -284,8 +507,8 @@ remove(const KeyType& key)
 }
 
 
-template <class Object, class HashFunc, class ExtractKey>
-auto LinkedHashTable<Object, HashFunc, ExtractKey>::
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class ClockBit, class Expiry>
+auto LinkedHashTable<Object, HashFunc, ExtractKey, Alloc, ClockBit, Expiry>::
 erase(Iterator it) -> Iterator
 {
     int pos = bucketPos(getKey(*it)); // 找到位置
@@ -300,10 +523,9 @@ erase(Iterator it) -> Iterator
             else
                 prev->next = cur->next;
                 
-            cur->before->after = cur->after;
-            cur->after->before = cur->before;
             Node* after = cur->after;
-            delete cur;
+            unlink(cur);
+            destroyNode(cur);
             --nodeCount_;
             return after;
         }
@@ -314,10 +536,13 @@ erase(Iterator it) -> Iterator
 }
 
 
-template <class Object, class HashFunc, class ExtractKey>
-void LinkedHashTable<Object, HashFunc, ExtractKey>::resize(int hintCnt)
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class ClockBit, class Expiry>
+void LinkedHashTable<Object, HashFunc, ExtractKey, Alloc, ClockBit, Expiry>::resize(int hintCnt)
 {
     if (hintCnt <= (int)buckets_.size()) return;
+#ifdef HASH_TABLE_STATS
+    auto start = std::chrono::steady_clock::now();
+#endif
     int newSize = roundup(hintCnt);
     std::vector<Node*> tmp(newSize, nullptr);
 
@@ -338,22 +563,84 @@ void LinkedHashTable<Object, HashFunc, ExtractKey>::resize(int hintCnt)
         }
     }
     buckets_.swap(tmp);
+#ifdef HASH_TABLE_STATS
+    counters_.recordResize(std::chrono::steady_clock::now() - start);
+#endif
 }
 
 
-template <class Object, class HashFunc, class ExtractKey>
-void LinkedHashTable<Object, HashFunc, ExtractKey>::clear()
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class ClockBit, class Expiry>
+void LinkedHashTable<Object, HashFunc, ExtractKey, Alloc, ClockBit, Expiry>::clear()
 {
-    Node* cur = head_->after;
-    while (cur != head_)
+    // 分配器支持整体释放时只需析构元素，元素可平凡析构时连遍历都可省去
+    const bool bulk = HasBulkRelease<NodeAlloc>::value;
+    if (!bulk || !std::is_trivially_destructible<Object>::value)
     {
-        cur = cur->after;
-        delete cur->before;
+        Node* cur = head_->after;
+        while (cur != head_)
+        {
+            cur = cur->after;
+            if (bulk)
+                NodeAllocTraits::destroy(alloc_, cur->before);
+            else
+                destroyNode(cur->before);
+        }
     }
+    bulkRelease(alloc_);
+    std::fill(buckets_.begin(), buckets_.end(), nullptr);
     head_->after = head_;
     head_->before = head_;
+    hand_ = head_;
     nodeCount_ = 0;
 }
 
 
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class ClockBit, class Expiry>
+void LinkedHashTable<Object, HashFunc, ExtractKey, Alloc, ClockBit, Expiry>::evict(const Node* keep)
+{
+    if (nodeCount_ == 0 || (nodeCount_ == 1 && head_->after == keep)) return;
+    if (policy_ == EvictionPolicy::FIFO)
+    {
+        erase(head_->after != keep ? head_->after : head_->after->after);
+        return;
+    }
+    // 最多扫描两圈：第一圈清除所有访问位后必然找到可淘汰的节点
+    Node* cur = hand_;
+    while (true)
+    {
+        if (cur == head_)
+            cur = head_->after;
+        else if (cur == keep)
+            cur = cur->after;
+        else if (isReferenced(cur))
+        {
+            setReferenced(cur, false);
+            cur = cur->after;
+        }
+        else
+            break;
+    }
+    hand_ = cur;
+    erase(cur);
+}
+
+
+// 从链表头部开始删除已过期的元素，最多删除budget个，遇到未过期的元素即停止。
+// 所有元素的存活时间相同（且不调用moveToLast）时链表顺序就是过期顺序；
+// 存活时间不同时，排在未过期元素之后的过期元素留到以后删除，find仍会将其视为不存在
+template <class Object, class HashFunc, class ExtractKey, class Alloc, class ClockBit, class Expiry>
+int LinkedHashTable<Object, HashFunc, ExtractKey, Alloc, ClockBit, Expiry>::
+expire(TimePoint now, int budget)
+{
+    int count = 0;
+    while (count < budget && head_->after != head_ &&
+           nodeExpireTime(head_->after) <= now)
+    {
+        removeFirst();
+        ++count;
+    }
+    return count;
+}
+
+
 #endif // LINKED_HASH_TABLE_HPP
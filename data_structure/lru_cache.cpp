@@ -0,0 +1,325 @@
+#include "linked_hash_table.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// 按个数计算容量
+template <class Key, class Value>
+struct UnitWeight
+{
+    size_t operator()(const Key&, const Value&) const { return 1; }
+};
+
+
+// 分段加锁的LRU缓存
+// 每个分段是一个LinkedHashTable，链表头部为最久未使用的元素，命中时移到链表末尾。
+// Weigher返回每个元素的权重，容量为权重之和的上限（默认按个数，也可按字节数）
+template <class Key, class Value, class HashFunc = std::hash<Key>,
+          class Weigher = UnitWeight<Key, Value>>
+class LRUCache
+{
+public:
+    template <class Pair>
+    struct select1st
+    {
+        const typename Pair::first_type& operator()(const Pair& pair) const
+        { return pair.first; }
+    };
+
+    using Object = std::pair<const Key, Value>;
+    using Container = LinkedHashTable<Object, HashFunc, select1st<Object>>;
+    using KeyType = typename Container::KeyType;
+
+    struct Stats
+    {
+        long hits = 0;
+        long misses = 0;
+        long evictions = 0;
+
+        double hitRatio() const
+        { return hits + misses == 0 ? 0 : (double)hits / (hits + misses); }
+    };
+
+    // 容量平均分给各分段，shardCount取整为2的幂次方
+    LRUCache(size_t capacity, int shardCount = 16)
+        : shardBits_(log2(roundupPowerOfTwo(shardCount))),
+          shards_(1 << shardBits_)
+    {
+        size_t perShard = (capacity + shards_.size() - 1) / shards_.size();
+        for (auto& shard : shards_) shard.capacity = perShard;
+    }
+
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
+
+    // 查找，命中时拷贝value并将元素移到链表末尾
+    bool get(const KeyType& key, Value& value)
+    {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.table.find(key);
+        if (it == shard.table.end())
+        {
+            ++shard.stats.misses;
+            return false;
+        }
+        ++shard.stats.hits;
+        shard.table.moveToLast(it);
+        value = it->second;
+        return true;
+    }
+
+    // 插入或更新，超出容量时从链表头部开始淘汰
+    void put(const Key& key, const Value& value)
+    {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto res = shard.table.insert({key, value});
+        auto it = res.first;
+        if (!res.second)
+        {
+            shard.weight -= Weigher()(it->first, it->second);
+            it->second = value;
+            shard.table.moveToLast(it);
+        }
+        shard.weight += Weigher()(it->first, it->second);
+        evict(shard);
+    }
+
+    // 删除
+    bool remove(const KeyType& key)
+    {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.table.find(key);
+        if (it == shard.table.end()) return false;
+        shard.weight -= Weigher()(it->first, it->second);
+        shard.table.erase(it);
+        return true;
+    }
+
+    void clear()
+    {
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.table.clear();
+            shard.weight = 0;
+        }
+    }
+
+    // 以下统计各分段分别加锁，并发修改时结果只是近似值
+    int size() const
+    {
+        int count = 0;
+        for (const auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            count += shard.table.size();
+        }
+        return count;
+    }
+
+    size_t weight() const
+    {
+        size_t total = 0;
+        for (const auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.weight;
+        }
+        return total;
+    }
+
+    Stats stats() const
+    {
+        Stats total;
+        for (const auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total.hits += shard.stats.hits;
+            total.misses += shard.stats.misses;
+            total.evictions += shard.stats.evictions;
+        }
+        return total;
+    }
+
+    int shardCount() const { return shards_.size(); }
+
+private:
+    // 计数器放在分段内由分段锁保护，避免全局原子变量成为争用点；
+    // 分段之间填充一个缓存行，避免伪共享
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        Container table;
+        size_t weight = 0;
+        size_t capacity = 0;
+        Stats stats;
+        char padding[64];
+    };
+
+    // 淘汰最久未使用的元素，至少保留刚插入的一个元素
+    void evict(Shard& shard)
+    {
+        while (shard.weight > shard.capacity && shard.table.size() > 1)
+        {
+            auto it = shard.table.begin();
+            shard.weight -= Weigher()(it->first, it->second);
+            shard.table.removeFirst();
+            ++shard.stats.evictions;
+        }
+    }
+
+    // 用乘法哈希的高位选择分段，与分段内哈希表使用的低位相互独立
+    int shardPos(const KeyType& key) const
+    {
+        if (shardBits_ == 0) return 0;
+        uint64_t h = static_cast<uint64_t>(HashFunc()(key)) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<int>(h >> (64 - shardBits_));
+    }
+
+    Shard& shardOf(const KeyType& key) { return shards_[shardPos(key)]; }
+
+    static int log2(unsigned int n)
+    {
+        int bits = 0;
+        while ((1u << bits) < n) ++bits;
+        return bits;
+    }
+
+    // 取整为2的幂次方
+    static unsigned int roundupPowerOfTwo(unsigned int i)
+    {
+        --i;
+        i |= i >> 1;
+        i |= i >> 2;
+        i |= i >> 4;
+        i |= i >> 8;
+        i |= i >> 16;
+        return i + 1;
+    }
+
+    int shardBits_;
+    std::vector<Shard> shards_;
+};
+
+
+// 测试
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <thread>
+
+// Zipf分布的累积概率，s越大访问越集中
+std::vector<double> zipfCdf(int keyRange, double s)
+{
+    std::vector<double> cdf(keyRange);
+    double sum = 0;
+    for (int i = 0; i < keyRange; ++i)
+    {
+        sum += 1.0 / std::pow(i + 1, s);
+        cdf[i] = sum;
+    }
+    return cdf;
+}
+
+// 按累积概率生成key序列
+std::vector<int> zipfTrace(const std::vector<double>& cdf, int length, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(0, cdf.back());
+    std::vector<int> trace(length);
+    for (auto& key : trace)
+        key = std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin();
+    return trace;
+}
+
+
+// 回放访问序列，未命中时put，返回吞吐量（百万次操作/秒）
+double replay(LRUCache<int, long>& cache, const std::vector<std::vector<int>>& traces)
+{
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (const auto& trace : traces)
+    {
+        threads.emplace_back([&cache, &trace, &go]
+        {
+            while (!go.load()) std::this_thread::yield();
+            long value;
+            for (int key : trace)
+                if (!cache.get(key, value)) cache.put(key, key);
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& t : threads) t.join();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (double)traces.size() * traces[0].size() / sec / 1e6;
+}
+
+
+int main()
+{
+    using namespace std;
+    LRUCache<int, long> cache(3, 1);
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(3, 30);
+    long value = 0;
+    cout << cache.get(1, value) << " " << value << endl;
+    cache.put(4, 40); // 淘汰2
+    cout << cache.get(2, value) << " " << cache.get(3, value) << endl;
+    auto st = cache.stats();
+    cout << st.hits << " " << st.misses << " " << st.evictions << endl;
+
+    // 按字节数计算容量
+    struct StringBytes
+    {
+        size_t operator()(int, const string& s) const { return s.size(); }
+    };
+    LRUCache<int, string, hash<int>, StringBytes> bytes(16, 1);
+    bytes.put(1, "hello");
+    bytes.put(2, "world");
+    bytes.put(3, "cache!");
+    bytes.put(4, "lru");
+    cout << bytes.size() << " " << bytes.weight() << endl;
+
+    // Zipf访问序列下不同容量的命中率
+    const int keyRange = 1 << 20;
+    const int length = 1 << 20;
+    cout << fixed << setprecision(3);
+    cout << setw(8) << "s" << setw(12) << "capacity" << setw(12) << "hit ratio" << endl;
+    for (double s : {0.8, 0.99, 1.2})
+    {
+        auto trace = zipfTrace(zipfCdf(keyRange, s), length, 1);
+        for (int capacity : {keyRange / 100, keyRange / 20, keyRange / 10})
+        {
+            LRUCache<int, long> lru(capacity);
+            replay(lru, {trace});
+            cout << setw(8) << s << setw(12) << capacity
+                 << setw(12) << lru.stats().hitRatio() << endl;
+        }
+    }
+
+    // 多线程吞吐量
+    auto cdf = zipfCdf(keyRange, 0.99);
+    cout << setw(8) << "threads" << setw(12) << "Mops/s" << setw(12) << "hit ratio" << endl;
+    for (int threads = 1; threads <= 16; threads *= 2)
+    {
+        vector<vector<int>> traces;
+        for (int t = 0; t < threads; ++t)
+            traces.push_back(zipfTrace(cdf, length / 4, t));
+        LRUCache<int, long> lru(keyRange / 20, 64);
+        double mops = replay(lru, traces);
+        cout << setw(8) << threads << setw(12) << mops
+             << setw(12) << lru.stats().hitRatio() << endl;
+    }
+    return 0;
+}
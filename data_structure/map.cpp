@@ -2,7 +2,9 @@
 #include "rb_tree.hpp"
 
 // 基于红黑树的有序map
-template <class Key, class Value, class Compare = std::less<Key>>
+// OrderStatistic：为std::true_type时支持rank/select/countRange
+template <class Key, class Value, class Compare = std::less<Key>,
+          class OrderStatistic = std::false_type>
 class Map
 {
 public:
@@ -14,7 +16,8 @@ public:
     };
 
     using Object = std::pair<const Key, Value>;
-    using Tree = RBTree<Object, Key, select1st<Object>, Compare>;
+    using Tree = RBTree<Object, Key, select1st<Object>, Compare,
+                        std::allocator<Object>, OrderStatistic>;
     using Iterator = typename Tree::Iterator;
     using ConstIterator = typename Tree::ConstIterator;
     using KeyType = typename Tree::KeyType;
@@ -30,9 +33,36 @@ public:
     Iterator find(const KeyType& key) {return tree_.find(key);}
     ConstIterator find(const KeyType& key) const {return tree_.find(key);}
 
+    // 第一个不小于/大于key的元素
+    Iterator lowerBound(const KeyType& key) { return tree_.lowerBound(key); }
+    ConstIterator lowerBound(const KeyType& key) const { return tree_.lowerBound(key); }
+
+    Iterator upperBound(const KeyType& key) { return tree_.upperBound(key); }
+    ConstIterator upperBound(const KeyType& key) const { return tree_.upperBound(key); }
+
+    std::pair<Iterator, Iterator> equalRange(const KeyType& key)
+    { return tree_.equalRange(key); }
+
+    std::pair<ConstIterator, ConstIterator> equalRange(const KeyType& key) const
+    { return tree_.equalRange(key); }
+
+    // 按顺序遍历key在[lo, hi]内的元素
+    template <class Fn>
+    void forEachInRange(const KeyType& lo, const KeyType& hi, Fn fn)
+    { tree_.forEachInRange(lo, hi, fn); }
+
+    template <class Fn>
+    void forEachInRange(const KeyType& lo, const KeyType& hi, Fn fn) const
+    { tree_.forEachInRange(lo, hi, fn); }
+
     Value& operator[](const KeyType& key)
     { return tree_.findOrInsert({key, Value()}).second; }
 
+    // 由有序区间[first, last)线性时间构建，原有元素被清空
+    template <class ForwardIt>
+    void buildFromSorted(ForwardIt first, ForwardIt last)
+    { tree_.buildFromSorted(first, last); }
+
     // 删除
     bool remove(const KeyType& key) { return tree_.remove(key); }
 
@@ -40,6 +70,17 @@ public:
     
     int size() const { return tree_.size(); }
 
+    // 小于key的元素个数
+    int rank(const KeyType& key) const { return tree_.rank(key); }
+
+    // 第i小的元素（从0开始）
+    Iterator select(int i) { return tree_.select(i); }
+    ConstIterator select(int i) const { return tree_.select(i); }
+
+    // key在[lo, hi]内的元素个数
+    int countRange(const KeyType& lo, const KeyType& hi) const
+    { return tree_.countRange(lo, hi); }
+
     ConstIterator begin() const { return tree_.begin(); }
     Iterator begin() { return tree_.begin(); }
 
@@ -54,6 +95,7 @@ private:
 // 测试
 #include <iostream>
 #include <memory>
+#include <vector>
 
 int main()
 {
@@ -77,5 +119,26 @@ int main()
     for (const auto& x : map) cout << *x.second << " ";
     cout << endl;
 
+    // 排行榜：按分数排序，查询名次和第i名
+    Map<int, const char*, greater<int>, true_type> board;
+    board.insert({92, "alice"});
+    board.insert({85, "bob"});
+    board.insert({97, "carol"});
+    board.insert({78, "dave"});
+    cout << board.rank(85) + 1 << " " << board.select(0)->second << " "
+         << board.countRange(95, 80) << endl;
+
+    // 分数在[95, 80]内的选手
+    board.forEachInRange(95, 80, [](const auto& x) { cout << x.second << " "; });
+    cout << endl;
+
+    // 由有序快照重建
+    vector<pair<int, int>> snapshot;
+    for (int i = 0; i < 10; ++i) snapshot.push_back({i, i * i});
+    Map<int, int> squares;
+    squares.buildFromSorted(snapshot.begin(), snapshot.end());
+    Map<int, int> copy(squares);
+    cout << copy.size() << " " << copy.find(7)->second << endl;
+
     return 0;
 }
@@ -0,0 +1,350 @@
+#include "hash_table.hpp"
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 内存映射的只读哈希索引
+// save()把key-value对写成扁平的文件镜像：文件头、各桶的起始下标（CSR格式）、按桶排列的元素。
+// open()只mmap文件并校验文件头（O(1)），find()直接在映射的内存上查找，无需反序列化，
+// 查找时才检查所查桶的起始下标，损坏的文件不会导致越界访问。
+// Key和Value必须可平凡拷贝，HashFunc在不同进程间必须得到相同的结果
+template <class Key, class Value, class HashFunc = std::hash<Key>>
+class MappedHashTable
+{
+    static_assert(std::is_trivially_copyable<Key>::value, "Key must be trivially copyable");
+    static_assert(std::is_trivially_copyable<Value>::value, "Value must be trivially copyable");
+public:
+    struct Entry
+    {
+        Key key;
+        Value value;
+    };
+
+    MappedHashTable(): base_(nullptr), length_(0), header_(nullptr),
+                       offsets_(nullptr), entries_(nullptr) {}
+
+    ~MappedHashTable() { close(); }
+
+    MappedHashTable(const MappedHashTable&) = delete;
+    MappedHashTable& operator=(const MappedHashTable&) = delete;
+
+    MappedHashTable(MappedHashTable&& rhs) noexcept: MappedHashTable()
+    { swap(rhs); }
+
+    MappedHashTable& operator=(MappedHashTable&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            close();
+            swap(rhs);
+        }
+        return *this;
+    }
+
+    void swap(MappedHashTable& rhs) noexcept
+    {
+        using std::swap;
+        swap(base_, rhs.base_);
+        swap(length_, rhs.length_);
+        swap(header_, rhs.header_);
+        swap(offsets_, rhs.offsets_);
+        swap(entries_, rhs.entries_);
+    }
+
+    // 将[first, last)内的pair(key, value)写入文件，key不能重复
+    template <class InputIt>
+    static bool save(InputIt first, InputIt last, const std::string& path);
+
+    // 保存HashTable、HashMap等以pair(key, value)为元素的容器
+    template <class Container>
+    static bool save(const Container& c, const std::string& path)
+    { return save(c.begin(), c.end(), path); }
+
+    // 映射文件，文件格式不匹配时返回false
+    bool open(const std::string& path);
+
+    void close()
+    {
+        if (base_) ::munmap(base_, length_);
+        base_ = nullptr;
+        length_ = 0;
+        header_ = nullptr;
+        offsets_ = nullptr;
+        entries_ = nullptr;
+    }
+
+    bool isOpen() const { return base_ != nullptr; }
+
+    // 查找，未找到返回nullptr
+    const Value* find(const Key& key) const
+    {
+        if (!header_ || header_->entryCount == 0) return nullptr;
+        uint64_t pos = HashFunc()(key) % header_->bucketCount;
+        uint64_t first = offsets_[pos];
+        uint64_t last = offsets_[pos + 1];
+        if (first > last || last > header_->entryCount) return nullptr; // 文件已损坏
+        for (uint64_t i = first; i < last; ++i)
+        {
+            if (entries_[i].key == key) return &entries_[i].value;
+        }
+        return nullptr;
+    }
+
+    int count(const Key& key) const { return find(key) != nullptr; }
+
+    int size() const { return header_ ? header_->entryCount : 0; }
+    int bucketCount() const { return header_ ? header_->bucketCount : 0; }
+
+    const Entry* begin() const { return entries_; }
+    const Entry* end() const { return entries_ + size(); }
+
+private:
+    static constexpr char kMagic[8] = {'H', 'T', 'I', 'M', 'A', 'G', 'E', '1'};
+    static constexpr uint64_t kAlign = 64;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t keySize;
+        uint32_t valueSize;
+        uint32_t entrySize;
+        uint32_t entryAlign;
+        uint64_t bucketCount;
+        uint64_t entryCount;
+        uint64_t offsetsPos; // 桶起始下标数组在文件中的位置
+        uint64_t entriesPos; // 元素数组在文件中的位置
+    };
+
+    static uint64_t alignUp(uint64_t n) { return (n + kAlign - 1) / kAlign * kAlign; }
+
+    // 校验各数组的位置已对齐且在文件范围内（比较时不做可能溢出的加法和乘法），
+    // 只检查文件头，不扫描桶起始下标数组
+    static bool validLayout(const Header* header, size_t length);
+
+    // 取整为2的幂次方
+    static uint64_t roundupPowerOfTwo(uint64_t i)
+    {
+        uint64_t n = 1;
+        while (n < i) n <<= 1;
+        return n;
+    }
+
+    void* base_;
+    size_t length_;
+    const Header* header_;
+    const uint64_t* offsets_;
+    const Entry* entries_;
+};
+
+template <class Key, class Value, class HashFunc>
+constexpr char MappedHashTable<Key, Value, HashFunc>::kMagic[8];
+
+template <class Key, class Value, class HashFunc>
+constexpr uint64_t MappedHashTable<Key, Value, HashFunc>::kAlign;
+
+
+template <class Key, class Value, class HashFunc>
+template <class InputIt>
+bool MappedHashTable<Key, Value, HashFunc>::
+save(InputIt first, InputIt last, const std::string& path)
+{
+    std::vector<Entry> entries;
+    for (; first != last; ++first)
+    {
+        Entry entry;
+        std::memset(&entry, 0, sizeof(entry)); // 填充字节清零，不把未初始化的内存写入文件
+        entry.key = first->first;
+        entry.value = first->second;
+        entries.push_back(entry);
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.keySize = sizeof(Key);
+    header.valueSize = sizeof(Value);
+    header.entrySize = sizeof(Entry);
+    header.entryAlign = alignof(Entry);
+    header.bucketCount = roundupPowerOfTwo(entries.size());
+    header.entryCount = entries.size();
+    header.offsetsPos = alignUp(sizeof(Header));
+    header.entriesPos = alignUp(header.offsetsPos + (header.bucketCount + 1) * sizeof(uint64_t));
+
+    // 计数排序，按桶排列元素
+    std::vector<uint64_t> buckets(entries.size());
+    std::vector<uint64_t> offsets(header.bucketCount + 1, 0);
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        buckets[i] = HashFunc()(entries[i].key) % header.bucketCount;
+        ++offsets[buckets[i] + 1];
+    }
+    for (uint64_t i = 0; i < header.bucketCount; ++i) offsets[i + 1] += offsets[i];
+
+    std::vector<Entry> sorted(entries.size());
+    std::vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < entries.size(); ++i) sorted[next[buckets[i]]++] = entries[i];
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    const std::vector<char> zeros(kAlign, 0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(zeros.data(), header.offsetsPos - sizeof(header));
+    out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    out.write(zeros.data(), header.entriesPos - header.offsetsPos - offsets.size() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(sorted.data()), sorted.size() * sizeof(Entry));
+    return static_cast<bool>(out.flush());
+}
+
+
+template <class Key, class Value, class HashFunc>
+bool MappedHashTable<Key, Value, HashFunc>::open(const std::string& path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(Header))
+    {
+        ::close(fd);
+        return false;
+    }
+    void* base = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) return false;
+
+    // 校验文件头，防止用不同的类型打开
+    const Header* header = static_cast<const Header*>(base);
+    size_t length = st.st_size;
+    bool valid = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 &&
+                 header->keySize == sizeof(Key) &&
+                 header->valueSize == sizeof(Value) &&
+                 header->entrySize == sizeof(Entry) &&
+                 header->entryAlign == alignof(Entry) &&
+                 validLayout(header, length);
+    if (!valid)
+    {
+        ::munmap(base, length);
+        return false;
+    }
+
+    base_ = base;
+    length_ = length;
+    header_ = header;
+    offsets_ = reinterpret_cast<const uint64_t*>(static_cast<const char*>(base) + header->offsetsPos);
+    entries_ = reinterpret_cast<const Entry*>(static_cast<const char*>(base) + header->entriesPos);
+    return true;
+}
+
+
+template <class Key, class Value, class HashFunc>
+bool MappedHashTable<Key, Value, HashFunc>::validLayout(const Header* header, size_t length)
+{
+    const uint64_t bucketCount = header->bucketCount;
+    const uint64_t entryCount = header->entryCount;
+    const uint64_t offsetsPos = header->offsetsPos;
+    const uint64_t entriesPos = header->entriesPos;
+    // size()和bucketCount()返回int
+    if (bucketCount == 0 || bucketCount >= INT_MAX || entryCount > INT_MAX) return false;
+    if (offsetsPos < sizeof(Header) || offsetsPos % alignof(uint64_t) != 0 ||
+        entriesPos % alignof(Entry) != 0)
+        return false;
+    if (offsetsPos > entriesPos || entriesPos > length) return false;
+    // 需要bucketCount + 1个下标和entryCount个元素
+    if (bucketCount >= (entriesPos - offsetsPos) / sizeof(uint64_t)) return false;
+    return entryCount <= (length - entriesPos) / sizeof(Entry);
+}
+
+
+// 测试
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+int main()
+{
+    using namespace std;
+    using namespace std::chrono;
+
+    struct select1st
+    {
+        const int& operator()(const pair<const int, long>& p) const { return p.first; }
+    };
+
+    const int n = 1 << 20;
+    const string path = "mapped_hash_table.img";
+
+    auto start = steady_clock::now();
+    HashTable<pair<const int, long>, hash<int>, select1st> table;
+    for (int i = 0; i < n; ++i) table.insert({i * 7, (long)i * i});
+    double buildSec = duration<double>(steady_clock::now() - start).count();
+
+    if (!MappedHashTable<int, long>::save(table, path))
+    {
+        cout << "save failed" << endl;
+        return 1;
+    }
+
+    start = steady_clock::now();
+    MappedHashTable<int, long> index;
+    if (!index.open(path))
+    {
+        cout << "open failed" << endl;
+        return 1;
+    }
+    double openSec = duration<double>(steady_clock::now() - start).count();
+
+    const long* value = index.find(7 * 1000);
+    cout << index.size() << " " << (value ? *value : -1) << " "
+         << index.count(3) << endl;
+
+    long sum = 0;
+    for (int i = 0; i < n; ++i) sum += *index.find(i * 7);
+    cout << sum << endl;
+
+    // 类型不匹配时拒绝打开
+    MappedHashTable<int, int> wrong;
+    cout << wrong.open(path) << endl;
+
+    // 损坏的文件：把文件中pos处改写为v后打开并调用check，测试后恢复原值
+    auto withCorrupted = [&path](size_t pos, uint64_t v, auto check)
+    {
+        fstream file(path, ios::in | ios::out | ios::binary);
+        uint64_t old = 0;
+        file.seekg(pos);
+        file.read(reinterpret_cast<char*>(&old), sizeof(old));
+        file.seekp(pos);
+        file.write(reinterpret_cast<const char*>(&v), sizeof(v));
+        file.flush();
+        MappedHashTable<int, long> corrupted;
+        check(corrupted.open(path), corrupted);
+        file.seekp(pos);
+        file.write(reinterpret_cast<const char*>(&old), sizeof(old));
+    };
+    // 位置和大小溢出时拒绝打开
+    auto printOpened = [](bool ok, const MappedHashTable<int, long>&) { cout << ok; };
+    withCorrupted(24, 1ULL << 61, printOpened); // bucketCount，(bucketCount + 1) * 8溢出
+    withCorrupted(48, ~0ULL - 63, printOpened); // entriesPos，加上元素数组大小后溢出
+    cout << endl;
+    // 桶4的结束下标越界：仍能打开，查找该桶返回nullptr，其他桶不受影响
+    withCorrupted(64 + 8 * 5, 1ULL << 40, [](bool ok, const MappedHashTable<int, long>& t)
+    {
+        cout << ok << " " << (t.find(4) == nullptr) << " " << *t.find(7 * 1000) << endl;
+    });
+
+    cout << "build: " << buildSec * 1000 << " ms, open: " << openSec * 1000 << " ms" << endl;
+
+    index.close();
+    remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,175 @@
+#ifndef NODE_POOL_HPP
+#define NODE_POOL_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 节点内存池
+// 按块（slab）批量申请内存，释放的节点挂到空闲链表上复用，
+// release()一次性归还所有块。每个容器独占一个内存池，拷贝得到的是新的空池
+template <class T>
+class NodePool
+{
+public:
+    using value_type = T;
+
+    template <class U>
+    struct rebind { using other = NodePool<U>; };
+
+    NodePool() noexcept: freeList_(nullptr), freeCount_(0), nextSlabSize_(kMinSlabSize) {}
+
+    NodePool(const NodePool&) noexcept: NodePool() {}
+
+    template <class U>
+    NodePool(const NodePool<U>&) noexcept: NodePool() {}
+
+    NodePool(NodePool&& rhs) noexcept
+        : slabs_(std::move(rhs.slabs_)),
+          freeList_(rhs.freeList_),
+          freeCount_(rhs.freeCount_),
+          nextSlabSize_(rhs.nextSlabSize_)
+    {
+        rhs.slabs_.clear();
+        rhs.freeList_ = nullptr;
+        rhs.freeCount_ = 0;
+        rhs.nextSlabSize_ = kMinSlabSize;
+    }
+
+    NodePool& operator=(const NodePool&) noexcept { return *this; }
+
+    NodePool& operator=(NodePool&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            release();
+            slabs_.swap(rhs.slabs_);
+            std::swap(freeList_, rhs.freeList_);
+            std::swap(freeCount_, rhs.freeCount_);
+            std::swap(nextSlabSize_, rhs.nextSlabSize_);
+        }
+        return *this;
+    }
+
+    ~NodePool() { release(); }
+
+    T* allocate(std::size_t n)
+    {
+        if (n != 1) return static_cast<T*>(::operator new(n * sizeof(T)));
+        if (!freeList_) grow();
+        Chunk* chunk = freeList_;
+        freeList_ = chunk->next;
+        --freeCount_;
+        return reinterpret_cast<T*>(chunk);
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        if (n != 1)
+        {
+            ::operator delete(p);
+            return;
+        }
+        Chunk* chunk = reinterpret_cast<Chunk*>(p);
+        chunk->next = freeList_;
+        freeList_ = chunk;
+        ++freeCount_;
+    }
+
+    // 保证之后的n次分配不再申请内存：空闲节点不足时，把缺少的部分一次申请为一个连续的块
+    void reserve(std::size_t n)
+    {
+        if (n > freeCount_) addSlab(n - freeCount_);
+    }
+
+    // 归还所有块，之前分配的节点全部失效
+    void release() noexcept
+    {
+        for (Chunk* slab : slabs_) delete[] slab;
+        slabs_.clear();
+        freeList_ = nullptr;
+        freeCount_ = 0;
+        nextSlabSize_ = kMinSlabSize;
+    }
+
+    int slabCount() const { return slabs_.size(); }
+
+    bool operator==(const NodePool& rhs) const { return this == &rhs; }
+    bool operator!=(const NodePool& rhs) const { return this != &rhs; }
+
+private:
+    static constexpr int kMinSlabSize = 64;
+    static constexpr int kMaxSlabSize = 4096;
+
+    union Chunk
+    {
+        Chunk* next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    void grow()
+    {
+        addSlab(nextSlabSize_);
+        if (nextSlabSize_ < kMaxSlabSize) nextSlabSize_ *= 2;
+    }
+
+    // 申请n个节点的新块，按地址顺序串到空闲链表上
+    void addSlab(std::size_t n)
+    {
+        Chunk* slab = new Chunk[n];
+        slabs_.push_back(slab);
+        for (std::size_t i = 0; i < n - 1; ++i) slab[i].next = &slab[i + 1];
+        slab[n - 1].next = freeList_;
+        freeList_ = slab;
+        freeCount_ += n;
+    }
+
+    std::vector<Chunk*> slabs_;
+    Chunk* freeList_;
+    std::size_t freeCount_;
+    int nextSlabSize_;
+};
+
+
+// 判断分配器是否支持整体释放（release）
+template <class Alloc, class = void>
+struct HasBulkRelease : std::false_type {};
+
+template <class Alloc>
+struct HasBulkRelease<Alloc, decltype(std::declval<Alloc&>().release())>
+    : std::true_type {};
+
+template <class Alloc>
+inline void bulkRelease(Alloc& alloc, std::true_type) { alloc.release(); }
+
+template <class Alloc>
+inline void bulkRelease(Alloc&, std::false_type) {}
+
+template <class Alloc>
+inline void bulkRelease(Alloc& alloc)
+{ bulkRelease(alloc, HasBulkRelease<Alloc>()); }
+
+
+// 判断分配器是否支持预留节点（reserve）
+template <class Alloc, class = void>
+struct HasReserve : std::false_type {};
+
+template <class Alloc>
+struct HasReserve<Alloc, decltype(std::declval<Alloc&>().reserve(std::size_t()))>
+    : std::true_type {};
+
+template <class Alloc>
+inline void reserveNodes(Alloc& alloc, std::size_t n, std::true_type) { alloc.reserve(n); }
+
+template <class Alloc>
+inline void reserveNodes(Alloc&, std::size_t, std::false_type) {}
+
+// 支持时一次性预留n个节点的连续内存，否则什么也不做
+template <class Alloc>
+inline void reserveNodes(Alloc& alloc, std::size_t n)
+{ reserveNodes(alloc, n, HasReserve<Alloc>()); }
+
+
+#endif // NODE_POOL_HPP
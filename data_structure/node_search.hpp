@@ -0,0 +1,193 @@
+#ifndef NODE_SEARCH_HPP
+#define NODE_SEARCH_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// B树/B+树节点内的键查找
+// nodeLowerBound返回第一个不小于key的位置，nodeUpperBound返回第一个大于key的位置。
+// 一般的键类型用无分支二分查找：每步用条件传送选择区间，没有依赖数据的跳转。
+// 定义__AVX2__时（-mavx2），32/64位整数和浮点数的键先二分缩小到4个向量宽的窗口，
+// 再用256位比较统计窗口内小于（大于）key的个数。SSE2的128位比较实测不比无分支二分快，不使用
+
+namespace node_search
+{
+
+// 无分支二分查找，before(x)为true表示x位于答案之前；区间缩小到不超过window个元素时停止，
+// 返回窗口的起始位置，答案位于[base, base + n]内
+template <class T, class Before>
+inline const T* narrow(const T* base, int& n, int window, Before before)
+{
+    while (n > window)
+    {
+        int half = n / 2;
+        base = before(base[half]) ? base + half : base;
+        n -= half;
+    }
+    return base;
+}
+
+// 一般类型的键
+template <class T, class Before>
+inline int branchlessSearch(const T* first, int n, Before before)
+{
+    if (n == 0) return 0;
+    const T* base = narrow(first, n, 1, before);
+    return base - first + before(*base);
+}
+
+
+// SIMD比较，kLanes为0表示不支持
+template <class T, class = void>
+struct SimdOps
+{
+    static constexpr int kLanes = 0;
+};
+
+#ifdef __AVX2__
+
+template <class T>
+struct SimdOps<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) == 4>::type>
+{
+    static constexpr int kLanes = 8;
+
+    // 无符号数翻转符号位后按有符号数比较
+    static __m256i load(const T* p)
+    { return bias(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))); }
+
+    static __m256i broadcast(T key) { return bias(_mm256_set1_epi32((int32_t)key)); }
+
+    static int lessMask(__m256i v, __m256i key) { return movemask(_mm256_cmpgt_epi32(key, v)); }
+    static int greaterMask(__m256i v, __m256i key) { return movemask(_mm256_cmpgt_epi32(v, key)); }
+
+private:
+    static __m256i bias(__m256i v)
+    { return std::is_signed<T>::value ? v : _mm256_xor_si256(v, _mm256_set1_epi32(INT32_MIN)); }
+
+    static int movemask(__m256i mask)
+    { return _mm256_movemask_ps(_mm256_castsi256_ps(mask)); }
+};
+
+template <class T>
+struct SimdOps<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) == 8>::type>
+{
+    static constexpr int kLanes = 4;
+
+    static __m256i load(const T* p)
+    { return bias(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))); }
+
+    static __m256i broadcast(T key) { return bias(_mm256_set1_epi64x((int64_t)key)); }
+
+    static int lessMask(__m256i v, __m256i key) { return movemask(_mm256_cmpgt_epi64(key, v)); }
+    static int greaterMask(__m256i v, __m256i key) { return movemask(_mm256_cmpgt_epi64(v, key)); }
+
+private:
+    static __m256i bias(__m256i v)
+    { return std::is_signed<T>::value ? v : _mm256_xor_si256(v, _mm256_set1_epi64x(INT64_MIN)); }
+
+    static int movemask(__m256i mask)
+    { return _mm256_movemask_pd(_mm256_castsi256_pd(mask)); }
+};
+
+template <>
+struct SimdOps<float>
+{
+    static constexpr int kLanes = 8;
+
+    static __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+    static __m256 broadcast(float key) { return _mm256_set1_ps(key); }
+
+    static int lessMask(__m256 v, __m256 key)
+    { return _mm256_movemask_ps(_mm256_cmp_ps(v, key, _CMP_LT_OQ)); }
+
+    static int greaterMask(__m256 v, __m256 key)
+    { return _mm256_movemask_ps(_mm256_cmp_ps(v, key, _CMP_GT_OQ)); }
+};
+
+template <>
+struct SimdOps<double>
+{
+    static constexpr int kLanes = 4;
+
+    static __m256d load(const double* p) { return _mm256_loadu_pd(p); }
+    static __m256d broadcast(double key) { return _mm256_set1_pd(key); }
+
+    static int lessMask(__m256d v, __m256d key)
+    { return _mm256_movemask_pd(_mm256_cmp_pd(v, key, _CMP_LT_OQ)); }
+
+    static int greaterMask(__m256d v, __m256d key)
+    { return _mm256_movemask_pd(_mm256_cmp_pd(v, key, _CMP_GT_OQ)); }
+};
+
+#endif
+
+
+// 一般类型：无分支二分查找
+template <class Key, class = void>
+struct NodeSearch
+{
+    static int lowerBound(const Key* keys, int n, const Key& key)
+    { return branchlessSearch(keys, n, [&](const Key& x) { return x < key; }); }
+
+    static int upperBound(const Key* keys, int n, const Key& key)
+    { return branchlessSearch(keys, n, [&](const Key& x) { return !(key < x); }); }
+};
+
+// 支持SIMD的类型：二分缩小到kWindow个键，再对窗口做SIMD比较计数。
+// 窗口有序，比较结果的位掩码中小于key的位在低端连续，大于key的位在高端连续，
+// 用ctz计数即可，不需要popcnt指令
+template <class Key>
+struct NodeSearch<Key, typename std::enable_if<(SimdOps<Key>::kLanes > 0)>::type>
+{
+    using Ops = SimdOps<Key>;
+    static constexpr int kWindow = 4 * Ops::kLanes;
+
+    static int lowerBound(const Key* keys, int n, Key key)
+    {
+        const Key* base = narrow(keys, n, kWindow, [key](Key x) { return x < key; });
+        auto k = Ops::broadcast(key);
+        int count = 0; // 窗口内小于key的个数
+        int i = 0;
+        for (; i + Ops::kLanes <= n; i += Ops::kLanes)
+            count += __builtin_ctz(~Ops::lessMask(Ops::load(base + i), k));
+        for (; i < n; ++i) count += base[i] < key;
+        return base - keys + count;
+    }
+
+    static int upperBound(const Key* keys, int n, Key key)
+    {
+        const Key* base = narrow(keys, n, kWindow, [key](Key x) { return !(key < x); });
+        auto k = Ops::broadcast(key);
+        int count = 0; // 窗口内不大于key的个数
+        int i = 0;
+        for (; i + Ops::kLanes <= n; i += Ops::kLanes)
+            count += __builtin_ctz(Ops::greaterMask(Ops::load(base + i), k) | (1 << Ops::kLanes));
+        for (; i < n; ++i) count += !(key < base[i]);
+        return base - keys + count;
+    }
+};
+
+} // namespace node_search
+
+
+// 第一个不小于key的位置
+template <class Key>
+inline int nodeLowerBound(const Key* keys, int n, const Key& key)
+{ return node_search::NodeSearch<Key>::lowerBound(keys, n, key); }
+
+// 第一个大于key的位置
+template <class Key>
+inline int nodeUpperBound(const Key* keys, int n, const Key& key)
+{ return node_search::NodeSearch<Key>::upperBound(keys, n, key); }
+
+// 元素中的键不连续时（如B树节点存储pair），按getKey(元素)做无分支二分查找
+template <class T, class Key, class GetKey>
+inline int nodeLowerBound(const T* objects, int n, const Key& key, GetKey getKey)
+{ return node_search::branchlessSearch(objects, n, [&](const T& x) { return getKey(x) < key; }); }
+
+
+#endif // NODE_SEARCH_HPP
@@ -0,0 +1,682 @@
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "node_search.hpp"
+
+// 乐观锁耦合（Optimistic Lock Coupling）的并发B+树
+// 每个节点有一个版本号，最低位表示已废弃，次低位表示已加写锁。
+// 读操作不加锁：读节点前记下版本号，读完后校验版本号未变，否则从根节点重新开始；
+// 沿树向下时先校验父节点，再访问子节点。写操作只对被修改的节点加锁（把读到的版本号CAS为加锁状态），
+// 节点分裂、借键、合并在查找路径上提前进行（已满的节点先分裂，键数最少的节点先借键或合并），
+// 因此每次修改最多锁住父节点、当前节点和一个兄弟节点，加锁失败时同样重新开始，不会死锁。
+// 读操作可能读到正在修改的数据，要求Key和Value可平凡拷贝，校验失败时丢弃读到的结果。
+// 合并后废弃的节点可能仍被其他线程读取，先放入回收列表，在reclaim()或析构时释放
+template <class Key, class Value, int M>
+class OLCBPlusTree
+{
+    static_assert(std::is_trivially_copyable<Key>::value, "Key must be trivially copyable");
+    static_assert(std::is_trivially_copyable<Value>::value, "Value must be trivially copyable");
+    static_assert(M >= 4, "M must be at least 4");
+public:
+    using KeyType = Key;
+    using ValueType = Value;
+
+    OLCBPlusTree(): root_(new LeafNode()), size_(0) {}
+    ~OLCBPlusTree()
+    {
+        destroy(root_.load());
+        reclaim();
+    }
+
+    OLCBPlusTree(const OLCBPlusTree&) = delete;
+    OLCBPlusTree& operator=(const OLCBPlusTree&) = delete;
+
+    // 查找，找到时将值写入value
+    bool find(const KeyType& key, ValueType& value) const;
+
+    bool contains(const KeyType& key) const
+    {
+        ValueType value;
+        return find(key, value);
+    }
+
+    // 插入，key已存在时返回false
+    bool insert(const KeyType& key, const ValueType& value);
+
+    // 删除
+    bool remove(const KeyType& key);
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    // 释放合并后废弃的节点，调用时不能有其他线程访问树
+    void reclaim()
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex_);
+        for (NodeBase* node : retired_) destroyNode(node);
+        retired_.clear();
+    }
+
+private:
+    static constexpr int kMinKeyNum = (M + 1) / 2 - 1;
+    static constexpr int kMaxKeyNum = M - 1;
+
+    // 节点的版本锁
+    class VersionLock
+    {
+    public:
+        // 等待写锁释放后返回版本号，节点已废弃时needRestart置为true
+        uint64_t readLock(bool& needRestart) const
+        {
+            uint64_t version = version_.load(std::memory_order_acquire);
+            for (int spin = 0; version & kLocked; ++spin)
+            {
+                if (spin >= 64) std::this_thread::yield();
+                version = version_.load(std::memory_order_acquire);
+            }
+            if (version & kObsolete) needRestart = true;
+            return version;
+        }
+
+        // 读取的数据有效时版本号不变
+        bool validate(uint64_t version) const
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return version_.load(std::memory_order_relaxed) == version;
+        }
+
+        // 读到版本号之后没有被修改时加写锁
+        bool upgrade(uint64_t version)
+        {
+            return version_.compare_exchange_strong(version, version + kLocked,
+                                                    std::memory_order_acquire);
+        }
+
+        // 解锁并增加版本号
+        void writeUnlock() { version_.fetch_add(kLocked, std::memory_order_release); }
+
+        // 解锁并标记为已废弃
+        void writeUnlockObsolete()
+        { version_.fetch_add(kLocked + kObsolete, std::memory_order_release); }
+
+    private:
+        static constexpr uint64_t kObsolete = 1;
+        static constexpr uint64_t kLocked = 2;
+
+        std::atomic<uint64_t> version_{4};
+    };
+
+    // 节点基类
+    struct NodeBase
+    {
+        VersionLock lock;
+        int keyCount = 0;
+        const bool leaf;
+        KeyType keys[M];
+
+        NodeBase(bool _leaf): leaf(_leaf) {}
+
+        bool isLeaf() const { return leaf; }
+
+        // 未校验的读取可能得到任意的键数量，限制在数组范围内
+        int count() const { return keyCount < 0 ? 0 : keyCount > M ? M : keyCount; }
+    };
+
+    // 索引节点
+    struct IndexNode : NodeBase
+    {
+        NodeBase* childs[M + 1] = {nullptr};
+
+        IndexNode(): NodeBase(false) {}
+    };
+
+    // 叶子节点
+    struct LeafNode : NodeBase
+    {
+        ValueType values[M];
+
+        LeafNode(): NodeBase(true) {}
+    };
+
+    // 分裂已加锁的节点，返回新的右兄弟，分隔键写入sep
+    static NodeBase* split(NodeBase* node, KeyType& sep);
+
+    // 在已加锁的父节点中插入分隔键和右子节点
+    static void insertChild(IndexNode* parent, const KeyType& sep, NodeBase* child);
+
+    // 已加锁的parent的第pos个子节点与右兄弟之间合并，合并时返回被废弃的右节点；
+    // 不能合并时向键数最少的一侧借一个键，toLeft表示该侧是左节点
+    NodeBase* rebalance(IndexNode* parent, int pos, NodeBase* left, NodeBase* right, bool toLeft);
+
+    void retire(NodeBase* node)
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex_);
+        retired_.push_back(node);
+    }
+
+    static void destroyNode(NodeBase* node)
+    {
+        if (node->isLeaf())
+            delete static_cast<LeafNode*>(node);
+        else
+            delete static_cast<IndexNode*>(node);
+    }
+
+    static void destroy(NodeBase* node)
+    {
+        if (!node->isLeaf())
+        {
+            IndexNode* index = static_cast<IndexNode*>(node);
+            for (int i = 0; i <= index->keyCount; ++i) destroy(index->childs[i]);
+        }
+        destroyNode(node);
+    }
+
+    std::atomic<NodeBase*> root_;
+    std::atomic<size_t> size_;
+    std::mutex retiredMutex_;
+    std::vector<NodeBase*> retired_;
+};
+
+
+template <class Key, class Value, int M>
+bool OLCBPlusTree<Key, Value, M>::find(const KeyType& key, ValueType& value) const
+{
+restart:
+    bool needRestart = false;
+    NodeBase* node = root_.load(std::memory_order_acquire);
+    uint64_t version = node->lock.readLock(needRestart);
+    if (needRestart || node != root_.load(std::memory_order_acquire)) goto restart;
+
+    while (!node->isLeaf())
+    {
+        IndexNode* index = static_cast<IndexNode*>(node);
+        NodeBase* child = index->childs[nodeUpperBound(index->keys, index->count(), key)];
+        if (!index->lock.validate(version)) goto restart; // 子节点指针有效后才访问子节点
+        // 读到子节点的版本号后再校验父节点，保证这个版本号是子节点仍挂在父节点下时读到的
+        uint64_t childVersion = child->lock.readLock(needRestart);
+        if (needRestart || !index->lock.validate(version)) goto restart;
+        node = child;
+        version = childVersion;
+    }
+
+    LeafNode* leaf = static_cast<LeafNode*>(node);
+    int n = leaf->count();
+    int pos = nodeLowerBound(leaf->keys, n, key);
+    bool found = pos < n && leaf->keys[pos] == key;
+    if (found) value = leaf->values[pos];
+    if (!leaf->lock.validate(version)) goto restart;
+    return found;
+}
+
+
+template <class Key, class Value, int M>
+bool OLCBPlusTree<Key, Value, M>::insert(const KeyType& key, const ValueType& value)
+{
+restart:
+    bool needRestart = false;
+    NodeBase* node = root_.load(std::memory_order_acquire);
+    uint64_t version = node->lock.readLock(needRestart);
+    if (needRestart || node != root_.load(std::memory_order_acquire)) goto restart;
+    IndexNode* parent = nullptr;
+    uint64_t parentVersion = 0;
+
+    while (true)
+    {
+        // 已满的节点先分裂，锁住父节点和当前节点，分裂后重新开始
+        if (node->keyCount >= kMaxKeyNum)
+        {
+            if (parent && !parent->lock.upgrade(parentVersion)) goto restart;
+            if (!node->lock.upgrade(version))
+            {
+                if (parent) parent->lock.writeUnlock();
+                goto restart;
+            }
+            KeyType sep;
+            NodeBase* brother = split(node, sep);
+            if (parent)
+            {
+                insertChild(parent, sep, brother);
+                parent->lock.writeUnlock();
+            }
+            else // 根节点分裂
+            {
+                IndexNode* root = new IndexNode();
+                root->keys[0] = sep;
+                root->childs[0] = node;
+                root->childs[1] = brother;
+                root->keyCount = 1;
+                root_.store(root, std::memory_order_release);
+            }
+            node->lock.writeUnlock();
+            goto restart;
+        }
+        if (node->isLeaf()) break;
+
+        if (parent && !parent->lock.validate(parentVersion)) goto restart;
+        IndexNode* index = static_cast<IndexNode*>(node);
+        NodeBase* child = index->childs[nodeUpperBound(index->keys, index->count(), key)];
+        if (!index->lock.validate(version)) goto restart;
+        uint64_t childVersion = child->lock.readLock(needRestart);
+        if (needRestart || !index->lock.validate(version)) goto restart;
+        parent = index;
+        parentVersion = version;
+        node = child;
+        version = childVersion;
+    }
+
+    LeafNode* leaf = static_cast<LeafNode*>(node);
+    int pos = nodeLowerBound(leaf->keys, leaf->count(), key);
+    if (pos < leaf->count() && leaf->keys[pos] == key)
+    {
+        if (!leaf->lock.validate(version)) goto restart;
+        return false;
+    }
+    if (!leaf->lock.upgrade(version)) goto restart;
+    if (parent && !parent->lock.validate(parentVersion))
+    {
+        leaf->lock.writeUnlock();
+        goto restart;
+    }
+    for (int i = leaf->keyCount; i > pos; --i)
+    {
+        leaf->keys[i] = leaf->keys[i - 1];
+        leaf->values[i] = leaf->values[i - 1];
+    }
+    leaf->keys[pos] = key;
+    leaf->values[pos] = value;
+    ++leaf->keyCount;
+    leaf->lock.writeUnlock();
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+
+template <class Key, class Value, int M>
+bool OLCBPlusTree<Key, Value, M>::remove(const KeyType& key)
+{
+restart:
+    bool needRestart = false;
+    NodeBase* node = root_.load(std::memory_order_acquire);
+    uint64_t version = node->lock.readLock(needRestart);
+    if (needRestart || node != root_.load(std::memory_order_acquire)) goto restart;
+    bool isRoot = true;
+
+    while (!node->isLeaf())
+    {
+        IndexNode* index = static_cast<IndexNode*>(node);
+        int pos = nodeUpperBound(index->keys, index->count(), key);
+        NodeBase* child = index->childs[pos];
+        if (!index->lock.validate(version)) goto restart;
+        uint64_t childVersion = child->lock.readLock(needRestart);
+        if (needRestart || !index->lock.validate(version)) goto restart;
+
+        // 子节点的键数最少时先向兄弟借键或与兄弟合并，锁住当前节点、子节点和兄弟节点
+        if (child->keyCount <= kMinKeyNum)
+        {
+            int leftPos = pos > 0 ? pos - 1 : pos;
+            NodeBase* sibling = index->childs[pos > 0 ? pos - 1 : pos + 1];
+            if (!index->lock.validate(version)) goto restart;
+            uint64_t siblingVersion = sibling->lock.readLock(needRestart);
+            if (needRestart || !index->lock.validate(version)) goto restart;
+
+            if (!index->lock.upgrade(version)) goto restart;
+            if (!child->lock.upgrade(childVersion))
+            {
+                index->lock.writeUnlock();
+                goto restart;
+            }
+            if (!sibling->lock.upgrade(siblingVersion))
+            {
+                child->lock.writeUnlock();
+                index->lock.writeUnlock();
+                goto restart;
+            }
+            NodeBase* left = pos > 0 ? sibling : child;
+            NodeBase* right = pos > 0 ? child : sibling;
+            NodeBase* merged = rebalance(index, leftPos, left, right, pos == 0);
+            if (merged)
+            {
+                merged->lock.writeUnlockObsolete();
+                retire(merged);
+            }
+            else
+            {
+                right->lock.writeUnlock();
+            }
+            if (isRoot && index->keyCount == 0) // 根节点只剩一个子节点，树降低一层
+            {
+                root_.store(left, std::memory_order_release);
+                left->lock.writeUnlock();
+                index->lock.writeUnlockObsolete();
+                retire(index);
+                goto restart;
+            }
+            left->lock.writeUnlock();
+            index->lock.writeUnlock();
+            goto restart;
+        }
+        node = child;
+        version = childVersion;
+        isRoot = false;
+    }
+
+    LeafNode* leaf = static_cast<LeafNode*>(node);
+    int pos = nodeLowerBound(leaf->keys, leaf->count(), key);
+    if (pos == leaf->count() || !(leaf->keys[pos] == key))
+    {
+        if (!leaf->lock.validate(version)) goto restart;
+        return false;
+    }
+    if (!leaf->lock.upgrade(version)) goto restart;
+    for (int i = pos; i < leaf->keyCount - 1; ++i)
+    {
+        leaf->keys[i] = leaf->keys[i + 1];
+        leaf->values[i] = leaf->values[i + 1];
+    }
+    --leaf->keyCount;
+    leaf->lock.writeUnlock();
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+
+template <class Key, class Value, int M>
+auto OLCBPlusTree<Key, Value, M>::split(NodeBase* node, KeyType& sep) -> NodeBase*
+{
+    int mid = node->keyCount / 2;
+    if (node->isLeaf())
+    {
+        LeafNode* cur = static_cast<LeafNode*>(node);
+        LeafNode* brother = new LeafNode();
+        for (int i = mid; i < cur->keyCount; ++i)
+        {
+            brother->keys[i - mid] = cur->keys[i];
+            brother->values[i - mid] = cur->values[i];
+        }
+        brother->keyCount = cur->keyCount - mid;
+        cur->keyCount = mid;
+        sep = brother->keys[0];
+        return brother;
+    }
+    // 中间的键上移到父节点
+    IndexNode* cur = static_cast<IndexNode*>(node);
+    IndexNode* brother = new IndexNode();
+    for (int i = mid + 1; i < cur->keyCount; ++i) brother->keys[i - mid - 1] = cur->keys[i];
+    for (int i = mid + 1; i <= cur->keyCount; ++i) brother->childs[i - mid - 1] = cur->childs[i];
+    brother->keyCount = cur->keyCount - mid - 1;
+    cur->keyCount = mid;
+    sep = cur->keys[mid];
+    return brother;
+}
+
+
+template <class Key, class Value, int M>
+void OLCBPlusTree<Key, Value, M>::
+insertChild(IndexNode* parent, const KeyType& sep, NodeBase* child)
+{
+    int pos = nodeUpperBound(parent->keys, parent->keyCount, sep);
+    for (int i = parent->keyCount; i > pos; --i)
+    {
+        parent->keys[i] = parent->keys[i - 1];
+        parent->childs[i + 1] = parent->childs[i];
+    }
+    parent->keys[pos] = sep;
+    parent->childs[pos + 1] = child;
+    ++parent->keyCount;
+}
+
+
+template <class Key, class Value, int M>
+auto OLCBPlusTree<Key, Value, M>::
+rebalance(IndexNode* parent, int pos, NodeBase* left, NodeBase* right, bool toLeft) -> NodeBase*
+{
+    bool leaf = left->isLeaf();
+    int mergedCount = left->keyCount + right->keyCount + (leaf ? 0 : 1);
+
+    if (mergedCount <= kMaxKeyNum) // 合并，右节点并入左节点
+    {
+        if (leaf)
+        {
+            LeafNode* dst = static_cast<LeafNode*>(left);
+            LeafNode* src = static_cast<LeafNode*>(right);
+            for (int i = 0; i < src->keyCount; ++i)
+            {
+                dst->keys[dst->keyCount + i] = src->keys[i];
+                dst->values[dst->keyCount + i] = src->values[i];
+            }
+        }
+        else // 父节点中的分隔键下移
+        {
+            IndexNode* dst = static_cast<IndexNode*>(left);
+            IndexNode* src = static_cast<IndexNode*>(right);
+            dst->keys[dst->keyCount] = parent->keys[pos];
+            for (int i = 0; i < src->keyCount; ++i) dst->keys[dst->keyCount + 1 + i] = src->keys[i];
+            for (int i = 0; i <= src->keyCount; ++i) dst->childs[dst->keyCount + 1 + i] = src->childs[i];
+        }
+        left->keyCount = mergedCount;
+        for (int i = pos; i < parent->keyCount - 1; ++i)
+        {
+            parent->keys[i] = parent->keys[i + 1];
+            parent->childs[i + 1] = parent->childs[i + 2];
+        }
+        --parent->keyCount;
+        return right;
+    }
+
+    // 兄弟节点向子节点移动一个键
+    if (leaf)
+    {
+        LeafNode* l = static_cast<LeafNode*>(left);
+        LeafNode* r = static_cast<LeafNode*>(right);
+        if (toLeft)
+        {
+            l->keys[l->keyCount] = r->keys[0];
+            l->values[l->keyCount] = r->values[0];
+            ++l->keyCount;
+            for (int i = 0; i < r->keyCount - 1; ++i)
+            {
+                r->keys[i] = r->keys[i + 1];
+                r->values[i] = r->values[i + 1];
+            }
+            --r->keyCount;
+        }
+        else
+        {
+            for (int i = r->keyCount; i > 0; --i)
+            {
+                r->keys[i] = r->keys[i - 1];
+                r->values[i] = r->values[i - 1];
+            }
+            r->keys[0] = l->keys[l->keyCount - 1];
+            r->values[0] = l->values[l->keyCount - 1];
+            ++r->keyCount;
+            --l->keyCount;
+        }
+        parent->keys[pos] = r->keys[0];
+    }
+    else // 经父节点的分隔键旋转
+    {
+        IndexNode* l = static_cast<IndexNode*>(left);
+        IndexNode* r = static_cast<IndexNode*>(right);
+        if (toLeft)
+        {
+            l->keys[l->keyCount] = parent->keys[pos];
+            l->childs[l->keyCount + 1] = r->childs[0];
+            ++l->keyCount;
+            parent->keys[pos] = r->keys[0];
+            for (int i = 0; i < r->keyCount - 1; ++i) r->keys[i] = r->keys[i + 1];
+            for (int i = 0; i < r->keyCount; ++i) r->childs[i] = r->childs[i + 1];
+            --r->keyCount;
+        }
+        else
+        {
+            for (int i = r->keyCount; i > 0; --i) r->keys[i] = r->keys[i - 1];
+            for (int i = r->keyCount + 1; i > 0; --i) r->childs[i] = r->childs[i - 1];
+            r->keys[0] = parent->keys[pos];
+            r->childs[0] = l->childs[l->keyCount];
+            ++r->keyCount;
+            parent->keys[pos] = l->keys[l->keyCount - 1];
+            --l->keyCount;
+        }
+    }
+    return nullptr;
+}
+
+
+// 测试
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <shared_mutex>
+
+// 对比读写锁保护的std::map
+template <class Key, class Value>
+class GlobalLockMap
+{
+public:
+    bool insert(const Key& key, const Value& value)
+    {
+        std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+        return map_.insert({key, value}).second;
+    }
+
+    bool remove(const Key& key)
+    {
+        std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+        return map_.erase(key) > 0;
+    }
+
+    bool find(const Key& key, Value& value) const
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        auto it = map_.find(key);
+        if (it == map_.end()) return false;
+        value = it->second;
+        return true;
+    }
+
+private:
+    mutable std::shared_timed_mutex mutex_;
+    std::map<Key, Value> map_;
+};
+
+
+// 混合负载，writePercent%的操作为插入和删除各半，其余为查找；返回吞吐量（百万次操作/秒）
+template <class Map>
+double throughput(Map& map, int threadCount, int opsPerThread, int keyRange, int writePercent)
+{
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t]
+        {
+            std::mt19937 rng(t);
+            while (!go.load()) std::this_thread::yield();
+            long value = 0;
+            for (int i = 0; i < opsPerThread; ++i)
+            {
+                int key = rng() % keyRange;
+                int op = rng() % 100;
+                if (op < writePercent / 2)
+                    map.insert(key, (long)key);
+                else if (op < writePercent)
+                    map.remove(key);
+                else
+                    map.find(key, value);
+            }
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& t : threads) t.join();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (double)threadCount * opsPerThread / sec / 1e6;
+}
+
+
+// threadCount个线程各自插入、删除key，每次操作后立即查找刚修改的key和之前插入的key，
+// 全部正确且最终元素个数正确时返回true
+template <int M>
+bool stress(int threadCount, int perThread)
+{
+    OLCBPlusTree<int, long, M> tree;
+    std::atomic<bool> ok(true);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t]
+        {
+            auto key = [&](int i) { return i * threadCount + t; };
+            long v = 0;
+            for (int i = 0; i < perThread; ++i)
+            {
+                tree.insert(key(i), i);
+                if (!tree.find(key(i), v) || v != i) ok = false;
+                if (!tree.find(key(i / 2), v) || v != i / 2) ok = false;
+            }
+            for (int i = 0; i < perThread; i += 2)
+            {
+                tree.remove(key(i));
+                if (tree.contains(key(i))) ok = false;
+                if (!tree.find(key(i + 1), v) || v != i + 1) ok = false;
+            }
+            for (int i = 0; i < perThread; ++i)
+            {
+                if (tree.find(key(i), v) != (i % 2 == 1) || (i % 2 == 1 && v != i)) ok = false;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    tree.reclaim();
+    return ok.load() && tree.size() == (size_t)threadCount * (perThread / 2);
+}
+
+
+int main()
+{
+    using namespace std;
+    OLCBPlusTree<int, long, 8> tree;
+    for (int i = 0; i < 100; ++i) tree.insert(i, i * 10L);
+    for (int i = 0; i < 100; i += 2) tree.remove(i);
+    long value = 0;
+    cout << tree.size() << " " << tree.find(31, value) << " " << value
+         << " " << tree.contains(30) << endl;
+
+    // 多个线程同时插入、删除各自的key，在其他线程仍在分裂、合并节点时检查自己的key；
+    // 阶数小时分裂和合并更频繁
+    cout << stress<4>(8, 20000) << stress<5>(8, 20000) << stress<6>(8, 20000)
+         << stress<16>(4, 50000) << endl;
+
+    // 预先以随机顺序插入一半的key
+    const int opsPerThread = 200000;
+    const int keyRange = 1 << 20;
+    vector<int> initKeys;
+    for (int i = 0; i < keyRange; i += 2) initKeys.push_back(i);
+    shuffle(initKeys.begin(), initKeys.end(), mt19937(1));
+    cout << fixed << setprecision(2);
+    for (int writePercent : {10, 50})
+    {
+        cout << writePercent << "% writes" << endl;
+        cout << setw(8) << "threads" << setw(14) << "olc" << setw(14) << "rwlock map"
+             << "   (Mops/s)" << endl;
+        for (int threads = 1; threads <= 16; threads *= 2)
+        {
+            OLCBPlusTree<int, long, 64> olc;
+            GlobalLockMap<int, long> global;
+            for (int key : initKeys) olc.insert(key, key);
+            for (int key : initKeys) global.insert(key, key);
+            double a = throughput(olc, threads, opsPerThread, keyRange, writePercent);
+            double b = throughput(global, threads, opsPerThread, keyRange, writePercent);
+            cout << setw(8) << threads << setw(14) << a << setw(14) << b << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "persistent_rb_tree.hpp"
+
+// 基于持久化红黑树的有序map
+// snapshot()为O(1)，每次更新只复制O(log n)个节点；快照只读，可交给其他线程无锁访问
+template <class Key, class Value, class Compare = std::less<Key>>
+class PersistentMap
+{
+public:
+    template <class Pair>
+    struct select1st
+    {
+        const typename Pair::first_type& operator()(const Pair& pair) const
+        { return pair.first; }
+    };
+
+    using Object = std::pair<const Key, Value>;
+    using Tree = PersistentRBTree<Object, Key, select1st<Object>, Compare>;
+    using ConstIterator = typename Tree::ConstIterator;
+    using KeyType = typename Tree::KeyType;
+
+    // 当前版本的快照
+    PersistentMap snapshot() const { return *this; }
+
+    // 插入，key已存在时返回false
+    bool insert(const Object& obj) { return tree_.insert(obj); }
+
+    // 插入或替换
+    void set(const KeyType& key, const Value& value)
+    { tree_.insertOrAssign({key, value}); }
+
+    // 查找，不存在返回nullptr
+    const Value* find(const KeyType& key) const
+    {
+        const Object* obj = tree_.find(key);
+        return obj ? &obj->second : nullptr;
+    }
+
+    int count(const KeyType& key) const { return tree_.count(key); }
+
+    // 删除
+    bool remove(const KeyType& key) { return tree_.remove(key); }
+
+    void clear() { tree_.clear(); }
+
+    int size() const { return tree_.size(); }
+
+    ConstIterator begin() const { return tree_.begin(); }
+    ConstIterator end() const { return tree_.end(); }
+
+private:
+    Tree tree_; // 底层容器：持久化红黑树
+};
+
+
+// 测试
+#include "rb_tree.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    using namespace std;
+    using namespace std::chrono;
+
+    PersistentMap<string, int> config;
+    config.set("timeout", 30);
+    config.set("retries", 3);
+    auto v1 = config.snapshot();
+
+    config.set("timeout", 60);
+    config.remove("retries");
+    config.insert({"port", 8080});
+
+    cout << *v1.find("timeout") << " " << v1.count("retries") << " " << v1.size() << endl;
+    cout << *config.find("timeout") << " " << config.count("retries") << " " << config.size() << endl;
+    for (const auto& x : config) cout << x.first << "=" << x.second << " ";
+    cout << endl;
+
+    // 写线程不断更新并发布新版本，读线程取得快照后无锁遍历
+    const int n = 100000;
+    PersistentMap<int, int> current;
+    for (int i = 0; i < n; ++i) current.set(i, 0);
+
+    mutex publishMutex; // 只保护发布槽的交换
+    PersistentMap<int, int> published = current.snapshot();
+    atomic<bool> consistent(true);
+
+    vector<thread> readers;
+    for (int r = 0; r < 2; ++r)
+    {
+        readers.emplace_back([&]
+        {
+            for (int k = 0; k < 20; ++k)
+            {
+                PersistentMap<int, int> view;
+                {
+                    lock_guard<mutex> lock(publishMutex);
+                    view = published.snapshot();
+                }
+                // 每个版本中所有value相同
+                int first = view.begin()->second;
+                for (const auto& x : view)
+                {
+                    if (x.second != first) consistent = false;
+                }
+            }
+        });
+    }
+    for (int version = 1; version <= 20; ++version)
+    {
+        for (int i = 0; i < n; ++i) current.set(i, version);
+        lock_guard<mutex> lock(publishMutex);
+        published = current.snapshot();
+    }
+    for (auto& t : readers) t.join();
+    cout << consistent.load() << endl;
+
+    // 快照与深拷贝的耗时对比
+    RBTree<pair<const int, int>, int, PersistentMap<int, int>::select1st<pair<const int, int>>> tree;
+    for (int i = 0; i < n; ++i) tree.insert({i, i});
+
+    auto start = steady_clock::now();
+    auto copy = tree;
+    double copyUs = duration<double, micro>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+    auto snap = current.snapshot();
+    double snapshotUs = duration<double, micro>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+    for (int i = 0; i < 1000; ++i) snap.set(i, -1);
+    double updateUs = duration<double, micro>(steady_clock::now() - start).count() / 1000;
+
+    cout << "deep copy: " << copyUs << " us, snapshot: " << snapshotUs
+         << " us, update: " << updateUs << " us (" << copy.size() << " " << snap.size() << ")" << endl;
+    return 0;
+}
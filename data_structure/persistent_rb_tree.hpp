@@ -0,0 +1,345 @@
+#ifndef PERSISTENT_RB_TREE_HPP
+#define PERSISTENT_RB_TREE_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// 持久化红黑树（路径复制）
+// 节点创建后不再修改，更新时只复制根到目标节点路径上的O(log n)个节点，其余子树与旧版本共享；
+// 节点使用原子引用计数，最后一个引用它的版本销毁时释放。
+// 拷贝（snapshot）只复制根指针，为O(1)；旧版本只读，可在其他线程中无锁访问。
+// 同一个树对象的读写仍需由调用者同步，不同线程应各自持有自己的版本。
+// 插入用Okasaki的平衡方法，删除用Kahrs的方法
+template <class Object, class Key = Object,
+          class ExtractKey = std::_Identity<Object>,
+          class Compare = std::less<Key>>
+class PersistentRBTree
+{
+    struct Node;
+    class NodeRef;
+    enum class Color : uint8_t { RED, BLACK };
+public:
+    class ConstIterator;
+    using KeyType = Key;
+
+    PersistentRBTree(): nodeCount_(0) {}
+
+    // 版本快照，与当前版本共享所有节点
+    PersistentRBTree snapshot() const { return *this; }
+
+    // 查找，不存在返回nullptr
+    const Object* find(const KeyType& key) const;
+
+    int count(const KeyType& key) const { return find(key) != nullptr; }
+
+    // 插入，key已存在时不修改并返回false
+    bool insert(const Object& obj);
+
+    // 插入，key已存在时替换原有元素
+    void insertOrAssign(const Object& obj);
+
+    // 删除
+    bool remove(const KeyType& key);
+
+    void clear()
+    {
+        root_ = NodeRef();
+        nodeCount_ = 0;
+    }
+
+    int size() const { return nodeCount_; }
+
+    ConstIterator begin() const { return ConstIterator(root_.get()); }
+    ConstIterator end() const { return ConstIterator(); }
+
+    // 迭代器，用栈保存从根到当前节点的路径（节点没有父指针）
+    class ConstIterator
+    {
+    public:
+        ConstIterator() {}
+        explicit ConstIterator(const Node* root) { pushLeft(root); }
+
+        bool operator==(const ConstIterator& it) const { return current() == it.current(); }
+        bool operator!=(const ConstIterator& it) const { return current() != it.current(); }
+
+        const Object& operator*() const { return stack_.back()->obj; }
+        const Object* operator->() const { return &stack_.back()->obj; }
+
+        ConstIterator& operator++()
+        {
+            const Node* node = stack_.back();
+            stack_.pop_back();
+            pushLeft(node->right.get());
+            return *this;
+        }
+
+        ConstIterator operator++(int)
+        {
+            ConstIterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+    private:
+        const Node* current() const { return stack_.empty() ? nullptr : stack_.back(); }
+
+        void pushLeft(const Node* node)
+        {
+            for (; node; node = node->left.get()) stack_.push_back(node);
+        }
+
+        std::vector<const Node*> stack_;
+    };
+
+private:
+    // 节点的引用，拷贝时增加引用计数，析构时减少，减为0时释放节点
+    class NodeRef
+    {
+    public:
+        NodeRef(): node_(nullptr) {}
+        explicit NodeRef(Node* node): node_(node) {} // 接管新建的节点
+
+        NodeRef(const NodeRef& rhs): node_(rhs.node_)
+        {
+            if (node_) node_->refCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        NodeRef(NodeRef&& rhs) noexcept: node_(rhs.node_) { rhs.node_ = nullptr; }
+
+        NodeRef& operator=(NodeRef rhs) noexcept
+        {
+            std::swap(node_, rhs.node_);
+            return *this;
+        }
+
+        ~NodeRef()
+        {
+            if (node_ && node_->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) delete node_;
+        }
+
+        const Node* get() const { return node_; }
+        const Node* operator->() const { return node_; }
+        explicit operator bool() const { return node_ != nullptr; }
+
+    private:
+        Node* node_;
+    };
+
+    struct Node
+    {
+        Object obj;
+        Color color;
+        NodeRef left;
+        NodeRef right;
+        mutable std::atomic<int> refCount;
+
+        Node(Color _color, const NodeRef& _left, const Object& _obj, const NodeRef& _right)
+            : obj(_obj), color(_color), left(_left), right(_right), refCount(1) {}
+    };
+
+    static const KeyType& getKey(const Object& obj)
+    { return ExtractKey()(obj); }
+
+    static bool comp(const KeyType& key1, const KeyType& key2)
+    { return Compare()(key1, key2); }
+
+    static bool isRed(const NodeRef& t) { return t && t->color == Color::RED; }
+    static bool isBlack(const NodeRef& t) { return t && t->color == Color::BLACK; }
+
+    static NodeRef make(Color color, const NodeRef& left, const Object& obj, const NodeRef& right)
+    { return NodeRef(new Node(color, left, obj, right)); }
+
+    // 同颜色、同元素、换子节点的副本
+    static NodeRef recolor(const NodeRef& t, Color color)
+    { return make(color, t->left, t->obj, t->right); }
+
+    // 消除连续的红色节点
+    static NodeRef balance(const NodeRef& left, const Object& obj, const NodeRef& right);
+
+    // 左/右子树黑高减少1后的调整
+    static NodeRef balanceLeft(const NodeRef& left, const Object& obj, const NodeRef& right);
+    static NodeRef balanceRight(const NodeRef& left, const Object& obj, const NodeRef& right);
+
+    // 合并删除节点的左右子树
+    static NodeRef append(const NodeRef& left, const NodeRef& right);
+
+    static NodeRef insertNode(const NodeRef& t, const Object& obj);
+    static NodeRef removeNode(const NodeRef& t, const KeyType& key);
+
+    NodeRef root_;
+    int nodeCount_;
+};
+
+
+template <class Object, class Key, class ExtractKey, class Compare>
+const Object* PersistentRBTree<Object, Key, ExtractKey, Compare>::
+find(const KeyType& key) const
+{
+    const Node* cur = root_.get();
+    while (cur)
+    {
+        if (comp(key, getKey(cur->obj)))
+            cur = cur->left.get();
+        else if (comp(getKey(cur->obj), key))
+            cur = cur->right.get();
+        else
+            return &cur->obj;
+    }
+    return nullptr;
+}
+
+
+template <class Object, class Key, class ExtractKey, class Compare>
+bool PersistentRBTree<Object, Key, ExtractKey, Compare>::insert(const Object& obj)
+{
+    if (find(getKey(obj))) return false; // 已存在时不复制路径
+    insertOrAssign(obj);
+    return true;
+}
+
+
+template <class Object, class Key, class ExtractKey, class Compare>
+void PersistentRBTree<Object, Key, ExtractKey, Compare>::insertOrAssign(const Object& obj)
+{
+    if (!find(getKey(obj))) ++nodeCount_;
+    NodeRef root = insertNode(root_, obj);
+    root_ = isRed(root) ? recolor(root, Color::BLACK) : root;
+}
+
+
+template <class Object, class Key, class ExtractKey, class Compare>
+bool PersistentRBTree<Object, Key, ExtractKey, Compare>::remove(const KeyType& key)
+{
+    if (!find(key)) return false;
+    NodeRef root = removeNode(root_, key);
+    root_ = isRed(root) ? recolor(root, Color::BLACK) : root;
+    --nodeCount_;
+    return true;
+}
+
+
+template <class Object, class Key, class ExtractKey, class Compare>
+auto PersistentRBTree<Object, Key, ExtractKey, Compare>::
+insertNode(const NodeRef& t, const Object& obj) -> NodeRef
+{
+    if (!t) return make(Color::RED, NodeRef(), obj, NodeRef());
+    if (comp(getKey(obj), getKey(t->obj)))
+    {
+        NodeRef left = insertNode(t->left, obj);
+        if (t->color == Color::BLACK) return balance(left, t->obj, t->right);
+        return make(Color::RED, left, t->obj, t->right);
+    }
+    if (comp(getKey(t->obj), getKey(obj)))
+    {
+        NodeRef right = insertNode(t->right, obj);
+        if (t->color == Color::BLACK) return balance(t->left, t->obj, right);
+        return make(Color::RED, t->left, t->obj, right);
+    }
+    return make(t->color, t->left, obj, t->right); // 替换元素
+}
+
+
+template <class Object, class Key, class ExtractKey, class Compare>
+auto PersistentRBTree<Object, Key, ExtractKey, Compare>::
+removeNode(const NodeRef& t, const KeyType& key) -> NodeRef
+{
+    if (comp(key, getKey(t->obj)))
+    {
+        NodeRef left = removeNode(t->left, key);
+        if (isBlack(t->left)) return balanceLeft(left, t->obj, t->right);
+        return make(Color::RED, left, t->obj, t->right);
+    }
+    if (comp(getKey(t->obj), key))
+    {
+        NodeRef right = removeNode(t->right, key);
+        if (isBlack(t->right)) return balanceRight(t->left, t->obj, right);
+        return make(Color::RED, t->left, t->obj, right);
+    }
+    return append(t->left, t->right);
+}
+
+
+template <class Object, class Key, class ExtractKey, class Compare>
+auto PersistentRBTree<Object, Key, ExtractKey, Compare>::
+balance(const NodeRef& left, const Object& obj, const NodeRef& right) -> NodeRef
+{
+    const Color R = Color::RED, B = Color::BLACK;
+    if (isRed(left) && isRed(right))
+        return make(R, recolor(left, B), obj, recolor(right, B));
+    if (isRed(left) && isRed(left->left))
+        return make(R, recolor(left->left, B), left->obj, make(B, left->right, obj, right));
+    if (isRed(left) && isRed(left->right))
+        return make(R, make(B, left->left, left->obj, left->right->left), left->right->obj,
+                    make(B, left->right->right, obj, right));
+    if (isRed(right) && isRed(right->right))
+        return make(R, make(B, left, obj, right->left), right->obj, recolor(right->right, B));
+    if (isRed(right) && isRed(right->left))
+        return make(R, make(B, left, obj, right->left->left), right->left->obj,
+                    make(B, right->left->right, right->obj, right->right));
+    return make(B, left, obj, right);
+}
+
+
+template <class Object, class Key, class ExtractKey, class Compare>
+auto PersistentRBTree<Object, Key, ExtractKey, Compare>::
+balanceLeft(const NodeRef& left, const Object& obj, const NodeRef& right) -> NodeRef
+{
+    const Color R = Color::RED, B = Color::BLACK;
+    if (isRed(left))
+        return make(R, recolor(left, B), obj, right);
+    if (isBlack(right))
+        return balance(left, obj, recolor(right, R));
+    assert(isRed(right) && isBlack(right->left));
+    return make(R, make(B, left, obj, right->left->left), right->left->obj,
+                balance(right->left->right, right->obj, recolor(right->right, R)));
+}
+
+
+template <class Object, class Key, class ExtractKey, class Compare>
+auto PersistentRBTree<Object, Key, ExtractKey, Compare>::
+balanceRight(const NodeRef& left, const Object& obj, const NodeRef& right) -> NodeRef
+{
+    const Color R = Color::RED, B = Color::BLACK;
+    if (isRed(right))
+        return make(R, left, obj, recolor(right, B));
+    if (isBlack(left))
+        return balance(recolor(left, R), obj, right);
+    assert(isRed(left) && isBlack(left->right));
+    return make(R, balance(recolor(left->left, R), left->obj, left->right->left), left->right->obj,
+                make(B, left->right->right, obj, right));
+}
+
+
+template <class Object, class Key, class ExtractKey, class Compare>
+auto PersistentRBTree<Object, Key, ExtractKey, Compare>::
+append(const NodeRef& left, const NodeRef& right) -> NodeRef
+{
+    const Color R = Color::RED, B = Color::BLACK;
+    if (!left) return right;
+    if (!right) return left;
+    if (isRed(left) && isRed(right))
+    {
+        NodeRef mid = append(left->right, right->left);
+        if (isRed(mid))
+            return make(R, make(R, left->left, left->obj, mid->left), mid->obj,
+                        make(R, mid->right, right->obj, right->right));
+        return make(R, left->left, left->obj, make(R, mid, right->obj, right->right));
+    }
+    if (isBlack(left) && isBlack(right))
+    {
+        NodeRef mid = append(left->right, right->left);
+        if (isRed(mid))
+            return make(R, make(B, left->left, left->obj, mid->left), mid->obj,
+                        make(B, mid->right, right->obj, right->right));
+        return balanceLeft(left->left, left->obj, make(B, mid, right->obj, right->right));
+    }
+    if (isRed(right))
+        return make(R, append(left, right->left), right->obj, right->right);
+    return make(R, left->left, left->obj, append(left->right, right));
+}
+
+#endif // PERSISTENT_RB_TREE_HPP
@@ -4,17 +4,41 @@
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "node_pool.hpp"
+
+// 节点中记录的子树大小（顺序统计）
+template <bool Enable>
+struct SubtreeSize
+{
+    int size;
+};
+
+template <>
+struct SubtreeSize<false> {};
 
 // 红黑树
 // Object：节点存储的对象，Key：键类型
 // ExtractKey：键值提取函数对象，Compare：元素比较函数对象
+// Alloc：节点分配器，可使用NodePool复用节点内存
+// OrderStatistic：为std::true_type时节点记录子树大小，支持O(log n)的rank/select
 template <class Object, class Key = Object,
           class ExtractKey = std::_Identity<Object>,
-          class Compare = std::less<Key>>
+          class Compare = std::less<Key>,
+          class Alloc = std::allocator<Object>,
+          class OrderStatistic = std::false_type>
 class RBTree
 {
     template <class NodePtr> struct IteratorT;
     struct Node;
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
+    using SizeTag = std::integral_constant<bool, OrderStatistic::value>;
+    enum class Color : uint8_t { RED, BLACK };
 public:
     using Iterator = IteratorT<Node*>;
     using ConstIterator = IteratorT<const Node*>;
@@ -25,6 +49,7 @@ public:
         nil_ = static_cast<Node*>(::malloc(sizeof(Node)));
         nil_->color = Color::BLACK;
         nil_->left = nil_->right = nil_;
+        setSize(nil_, 0);
         root_ = nil_;
     }
 
@@ -32,7 +57,7 @@ public:
 
     // 拷贝构造函数
     RBTree(const RBTree& rhs): RBTree()
-    { root_ = clone(rhs, rhs.root_, nil_); }
+    { buildBalanced(rhs.begin(), rhs.size()); }
 
     // 移动构造函数
     RBTree(RBTree&& rhs): RBTree() { rhs.swap(*this); }
@@ -61,6 +86,7 @@ public:
         swap(root_, rhs.root_);
         swap(nil_, rhs.nil_);
         swap(nodeCount_, rhs.nodeCount_);
+        swap(alloc_, rhs.alloc_);
     }
 
     // 查找
@@ -70,6 +96,40 @@ public:
     Iterator find(const KeyType& key)
     { return Iterator(const_cast<Node*>(_find(key)), this); }
 
+    // 第一个不小于key的元素
+    ConstIterator lowerBound(const KeyType& key) const
+    { return ConstIterator(_lowerBound(key), this); }
+
+    Iterator lowerBound(const KeyType& key)
+    { return Iterator(const_cast<Node*>(_lowerBound(key)), this); }
+
+    // 第一个大于key的元素
+    ConstIterator upperBound(const KeyType& key) const
+    { return ConstIterator(_upperBound(key), this); }
+
+    Iterator upperBound(const KeyType& key)
+    { return Iterator(const_cast<Node*>(_upperBound(key)), this); }
+
+    // 等于key的元素区间[first, second)
+    std::pair<ConstIterator, ConstIterator> equalRange(const KeyType& key) const
+    { return {lowerBound(key), upperBound(key)}; }
+
+    std::pair<Iterator, Iterator> equalRange(const KeyType& key)
+    { return {lowerBound(key), upperBound(key)}; }
+
+    // 按顺序对key在[lo, hi]内的元素调用fn
+    template <class Fn>
+    void forEachInRange(const KeyType& lo, const KeyType& hi, Fn fn) const
+    {
+        for (auto it = lowerBound(lo); it != end() && !comp(hi, getKey(*it)); ++it) fn(*it);
+    }
+
+    template <class Fn>
+    void forEachInRange(const KeyType& lo, const KeyType& hi, Fn fn)
+    {
+        for (auto it = lowerBound(lo); it != end() && !comp(hi, getKey(*it)); ++it) fn(*it);
+    }
+
     // 插入
     std::pair<Iterator, bool>
     insert(const Object& obj) { return _insert(obj); }
@@ -85,13 +145,55 @@ public:
     Object& findOrInsert(const Object& obj) { return *insert(obj).first; }
     Object& findOrInsert(Object&& obj) { return *insert(std::move(obj)).first; }
 
+    // 由有序区间[first, last)线性时间构建平衡树，原有元素被清空
+    // 区间须按Compare非递减排列，分配器支持预留时所有节点一次分配
+    template <class ForwardIt>
+    void buildFromSorted(ForwardIt first, ForwardIt last)
+    {
+        int n = 0;
+        for (ForwardIt it = first; it != last; ++it) ++n;
+        buildBalanced(first, n);
+    }
+
     // 删除
     bool remove(const KeyType& key);
 
-    void clear() { destroy(root_); }
+    // 集合运算（按集合语义，元素不重复），基于join的分治算法：
+    // 以rhs的根拆分本树，左右两侧分别递归后再join。黑高不存储在节点中，每次join都从头计算，
+    // 耗时O(log n)而不是O(|h1 - h2|)，拆分为O(log^2 n)，因此复杂度为O(m log(n/m + 1) log n)，
+    // unionWith另有复制rhs的O(m)。
+    // threadCount > 1时，规模足够大的两个递归调用并行执行
+    void unionWith(const RBTree& rhs, int threadCount = 1);
+    void intersectWith(const RBTree& rhs, int threadCount = 1);
+    void differenceWith(const RBTree& rhs, int threadCount = 1);
+
+    // 把rhs拼接到末尾，rhs的元素须都大于本树的元素，rhs被清空。
+    // 复杂度O(log^2 n + min(n, m))：拆出最大节点时有O(log n)次join，每次计算黑高O(log n)；
+    // 节点较少一侧的所有节点要改挂到另一侧的哨兵上，min(n, m)较大时这一项占主要部分
+    void join(RBTree& rhs);
+
+    // 大于key的元素移入right（right原有元素被清空），复杂度O(log^2 n + k)，k为移出的元素个数
+    void split(const KeyType& key, RBTree& right);
+
+    void clear();
 
     int size() const { return nodeCount_; }
 
+    // 顺序统计，需OrderStatistic为std::true_type
+    // 小于key的元素个数
+    int rank(const KeyType& key) const { return _rank(key, false); }
+
+    // 第i小的元素（从0开始），i越界时返回end()
+    ConstIterator select(int i) const
+    { return ConstIterator(_select(i), this); }
+
+    Iterator select(int i)
+    { return Iterator(const_cast<Node*>(_select(i)), this); }
+
+    // key在[lo, hi]内的元素个数
+    int countRange(const KeyType& lo, const KeyType& hi) const
+    { return comp(hi, lo) ? 0 : _rank(hi, true) - _rank(lo, false); }
+
     ConstIterator begin() const { return ConstIterator(minimum(), this); }
     Iterator begin() { return Iterator(const_cast<Node*>(minimum()), this); }
 
@@ -101,12 +203,20 @@ public:
 private:
     const Node* _find(const KeyType& key) const;
 
+    const Node* _lowerBound(const KeyType& key) const;
+    const Node* _upperBound(const KeyType& key) const;
+
     template <class X>
     std::pair<Iterator, bool> _insert(X&& x);
 
     template <class X>
     Iterator _insertEqual(X&& x);
 
+    // inclusive为false时返回小于key的元素个数，为true时返回不大于key的元素个数
+    int _rank(const KeyType& key, bool inclusive) const;
+
+    const Node* _select(int i) const;
+
     // 插入平衡调整
     void insertRebalance(Node* cur);
 
@@ -120,6 +230,162 @@ private:
     // child接到node的parent节点
     void setParentPtr(Node* node, Node* child);
 
+    // 子树大小，未启用顺序统计时均为空操作
+    static void setSize(Node* node, int size)
+    { setSize(node, size, SizeTag()); }
+
+    static void setSize(Node* node, int size, std::true_type)
+    { node->size = size; }
+
+    static void setSize(Node*, int, std::false_type) {}
+
+    // 由左右子树重新计算
+    static void updateSize(Node* node)
+    { setSize(node, sizeOf(node->left) + sizeOf(node->right) + 1); }
+
+    static int sizeOf(const Node* node)
+    { return sizeOf(node, SizeTag()); }
+
+    static int sizeOf(const Node* node, std::true_type)
+    { return node->size; }
+
+    static int sizeOf(const Node*, std::false_type)
+    { return 0; }
+
+    // node到根节点路径上的子树大小加delta
+    void addPathSize(Node* node, int delta)
+    { addPathSize(node, delta, SizeTag()); }
+
+    void addPathSize(Node* node, int delta, std::true_type)
+    {
+        for (; node != nil_; node = node->parent) node->size += delta;
+    }
+
+    void addPathSize(Node*, int, std::false_type) {}
+
+    // 以下为join算法使用的子树操作，子树的根可以为红色，且只修改子树内的节点（不写nil_），
+    // 因此不相交的子树可在不同线程上同时处理
+
+    struct SplitResult
+    {
+        Node* left;   // 小于key的子树
+        Node* middle; // 等于key的节点，不存在时为nil_
+        Node* right;  // 大于key的子树
+    };
+
+    // 并行执行的最小规模
+    static constexpr int kParallelCutoff = 1 << 14;
+
+    // 从node到nil路径上的黑色节点数（含node），沿左侧路径遍历，O(log n)
+    int blackHeight(const Node* node) const
+    {
+        int height = 0;
+        for (; node != nil_; node = node->left)
+        {
+            if (node->color == Color::BLACK) ++height;
+        }
+        return height;
+    }
+
+    // 设置node的左右子节点和颜色
+    Node* attach(Node* node, Node* left, Node* right, Color color)
+    {
+        node->left = left;
+        node->right = right;
+        node->color = color;
+        if (left != nil_) left->parent = node;
+        if (right != nil_) right->parent = node;
+        updateSize(node);
+        return node;
+    }
+
+    // 子树的左旋/右旋，返回新的根节点
+    Node* rotateLeft(Node* node)
+    {
+        Node* rchild = node->right;
+        attach(node, node->left, rchild->left, node->color);
+        return attach(rchild, node, rchild->right, rchild->color);
+    }
+
+    Node* rotateRight(Node* node)
+    {
+        Node* lchild = node->left;
+        attach(node, lchild->right, node->right, node->color);
+        return attach(lchild, lchild->left, node, lchild->color);
+    }
+
+    // 以mid连接left和right，left的元素都小于mid，right的元素都大于mid。
+    // 两侧的黑高都要重新计算，复杂度O(log n)
+    Node* joinNodes(Node* left, Node* mid, Node* right);
+
+    // 沿left的右侧路径找到黑高与right相同的黑色节点，在此处接入mid，再向上消除连续的红色节点
+    Node* joinRight(Node* left, int height, Node* mid, Node* right, int rightHeight);
+    Node* joinLeft(Node* left, int leftHeight, Node* mid, Node* right, int height);
+
+    // 连接left和right，left的元素都小于right
+    Node* concat(Node* left, Node* right);
+
+    // 拆出最大的节点last，返回其余节点构成的子树
+    Node* splitLast(Node* node, Node*& last);
+
+    SplitResult splitNode(Node* node, const KeyType& key);
+
+    // 被丢弃的节点存入garbage，运算结束后统一释放；n为两棵子树规模之和的估计，threads为可用线程数
+    Node* unionNodes(Node* t1, Node* t2, std::vector<Node*>& garbage, int n, int threads);
+    Node* intersectNodes(Node* t1, const RBTree& rhs, const Node* t2,
+                         std::vector<Node*>& garbage, int n, int threads);
+    Node* differenceNodes(Node* t1, const RBTree& rhs, const Node* t2,
+                          std::vector<Node*>& garbage, int n, int threads);
+
+    // 执行left(garbage, threads)和right(garbage, threads)，规模足够大时并行执行并平分线程
+    template <class LeftFn, class RightFn>
+    static void forkJoin(int n, int threads, std::vector<Node*>& garbage, LeftFn left, RightFn right)
+    {
+        if (threads > 1 && n >= kParallelCutoff)
+        {
+            std::vector<Node*> rightGarbage;
+            auto future = std::async(std::launch::async,
+                                     [&] { right(rightGarbage, threads - threads / 2); });
+            left(garbage, threads / 2);
+            future.get();
+            garbage.insert(garbage.end(), rightGarbage.begin(), rightGarbage.end());
+        }
+        else
+        {
+            left(garbage, threads);
+            right(garbage, threads);
+        }
+    }
+
+    void collect(Node* node, std::vector<Node*>& garbage)
+    {
+        if (node == nil_) return;
+        collect(node->left, garbage);
+        collect(node->right, garbage);
+        garbage.push_back(node);
+    }
+
+    // 集合运算结束：设置根节点，释放丢弃的节点
+    void finishSetOperation(Node* root, std::vector<Node*>& garbage)
+    {
+        root_ = root;
+        root_->parent = nil_;
+        root_->color = Color::BLACK;
+        nodeCount_ -= garbage.size();
+        for (Node* node : garbage) destroyNode(node);
+    }
+
+    // 子树中指向oldNil的指针改为newNil，返回子树的节点数
+    static int relink(Node*& node, Node* oldNil, Node* newNil)
+    {
+        if (node == oldNil)
+        {
+            node = newNil;
+            return 0;
+        }
+        return 1 + relink(node->left, oldNil, newNil) + relink(node->right, oldNil, newNil);
+    }
+
     const Node* minimum() const
     {
         const Node* cur = root_;
@@ -127,26 +393,45 @@ private:
         return cur;
     }
 
-    void destroy(Node*& node)
+    // bulk为true时只析构元素，内存由分配器整体释放
+    void destroy(Node*& node, bool bulk)
     {
         if (node != nil_)
         {
-            destroy(node->left);
-            destroy(node->right);
-            delete node;
+            destroy(node->left, bulk);
+            destroy(node->right, bulk);
+            if (bulk)
+                NodeAllocTraits::destroy(alloc_, node);
+            else
+                destroyNode(node);
             node = nil_;
         }
     }
 
-    Node* clone(const RBTree& tree, Node* cur, Node* parent) const
+    // 由first开始的n个有序元素构建平衡树
+    template <class ForwardIt>
+    void buildBalanced(ForwardIt first, int n);
+
+    // 构建n个节点的平衡子树，返回其根节点
+    template <class ForwardIt>
+    Node* buildTree(ForwardIt first, int n);
+
+    // 按中序消耗it，构建n个节点的子树，深度为redDepth的节点涂红
+    template <class ForwardIt>
+    Node* buildSubtree(ForwardIt& it, int n, int depth, int redDepth);
+
+    template <class... Args>
+    Node* createNode(Args&&... args)
+    {
+        Node* node = NodeAllocTraits::allocate(alloc_, 1);
+        NodeAllocTraits::construct(alloc_, node, std::forward<Args>(args)...);
+        return node;
+    }
+
+    void destroyNode(Node* node)
     {
-        if (cur == tree.nil_) return nil_;
-        Node* copy = new Node(cur->obj);
-        copy->color = cur->color;
-        copy->parent = parent;
-        copy->left = clone(tree, cur->left, copy);
-        copy->right = clone(tree, cur->right, copy);
-        return copy;
+        NodeAllocTraits::destroy(alloc_, node);
+        NodeAllocTraits::deallocate(alloc_, node, 1);
     }
 
     static const KeyType& getKey(const Object& obj)
@@ -173,7 +458,7 @@ private:
         bool operator!=(const Self& it) const { return node != it.node; }
 
         ObjectRef operator*() const { return node->obj; }
-        ObjectPtr operator->() const { return &*this; }
+        ObjectPtr operator->() const { return &node->obj; }
 
         Self& operator++() { increase(); return *this; }
         Self operator++(int)
@@ -195,10 +480,8 @@ private:
         void decrease();
     };
 
-    enum class Color : uint8_t { RED, BLACK };
-
     // 节点
-    struct Node
+    struct Node : SubtreeSize<OrderStatistic::value>
     {
         Object obj;
         Color color;
@@ -214,12 +497,13 @@ private:
     Node* root_;
     Node* nil_; // 哨兵节点
     int nodeCount_;
+    NodeAlloc alloc_;
 };
 
 
-template <class Object, class KeyType, class ExtractKey, class Compare>
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
 template <class NodePtr>
-void RBTree<Object, KeyType, ExtractKey, Compare>::IteratorT<NodePtr>::
+void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::IteratorT<NodePtr>::
 increase()
 {
     if (node->right != tree->nil_)
@@ -235,9 +519,9 @@ increase()
 }
 
 
-template <class Object, class KeyType, class ExtractKey, class Compare>
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
 template <class NodePtr>
-void RBTree<Object, KeyType, ExtractKey, Compare>::IteratorT<NodePtr>::
+void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::IteratorT<NodePtr>::
 decrease()
 {
     if (node->left != tree->nil_)
@@ -253,8 +537,8 @@ decrease()
 }
 
 
-template <class Object, class KeyType, class ExtractKey, class Compare>
-inline void RBTree<Object, KeyType, ExtractKey, Compare>::
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+inline void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
 setParentPtr(Node* node, Node* child)
 {
     child->parent = node->parent;
@@ -267,8 +551,8 @@ setParentPtr(Node* node, Node* child)
 }
 
 
-template <class Object, class KeyType, class ExtractKey, class Compare>
-inline void RBTree<Object, KeyType, ExtractKey, Compare>::
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+inline void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
 leftRotation(Node* node)
 {
     Node* rchild = node->right;
@@ -279,11 +563,14 @@ leftRotation(Node* node)
 
     rchild->left = node;
     node->parent = rchild;
+
+    updateSize(node);
+    updateSize(rchild);
 }
 
 
-template <class Object, class KeyType, class ExtractKey, class Compare>
-inline void RBTree<Object, KeyType, ExtractKey, Compare>::
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+inline void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
 rightRotation(Node* node)
 {
     Node* lchild = node->left;
@@ -294,11 +581,14 @@ rightRotation(Node* node)
 
     lchild->right = node;
     node->parent = lchild;
+
+    updateSize(node);
+    updateSize(lchild);
 }
 
 
-template <class Object, class KeyType, class ExtractKey, class Compare>
-auto RBTree<Object, KeyType, ExtractKey, Compare>::
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
 _find(const KeyType& key) const ->  const Node*
 {
     const Node* cur = root_;
@@ -315,9 +605,53 @@ _find(const KeyType& key) const ->  const Node*
 }
 
 
-template <class Object, class KeyType, class ExtractKey, class Compare>
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+_lowerBound(const KeyType& key) const -> const Node*
+{
+    const Node* result = nil_;
+    const Node* cur = root_;
+    while (cur != nil_)
+    {
+        if (comp(getKey(cur->obj), key))
+        {
+            cur = cur->right;
+        }
+        else // cur不小于key，记录后继续在左子树中查找
+        {
+            result = cur;
+            cur = cur->left;
+        }
+    }
+    return result;
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+_upperBound(const KeyType& key) const -> const Node*
+{
+    const Node* result = nil_;
+    const Node* cur = root_;
+    while (cur != nil_)
+    {
+        if (comp(key, getKey(cur->obj)))
+        {
+            result = cur;
+            cur = cur->left;
+        }
+        else
+        {
+            cur = cur->right;
+        }
+    }
+    return result;
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
 template <class X>
-auto RBTree<Object, KeyType, ExtractKey, Compare>::
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
 _insert(X&& x) -> std::pair<Iterator, bool>
 {
     Node* parent = nil_;
@@ -332,27 +666,29 @@ _insert(X&& x) -> std::pair<Iterator, bool>
         else
             return {Iterator(cur, this), false};
     }
-    Node* node = new Node(std::forward<X>(x));
+    Node* node = createNode(std::forward<X>(x));
     node->left = node->right = nil_;
     node->parent = parent;
     node->color = Color::RED; // 新节点必为红色
 
     if (root_ == nil_)
         root_ = node;
-    else if (comp(getKey(x), getKey(parent->obj)))
+    else if (comp(getKey(node->obj), getKey(parent->obj)))
         parent->left = node;
     else
         parent->right = node;
 
+    setSize(node, 1);
+    addPathSize(parent, 1);
     ++nodeCount_;
     insertRebalance(node); // 平衡调整
     return {Iterator(node, this), true};
 }
 
 
-template <class Object, class KeyType, class ExtractKey, class Compare>
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
 template <class X>
-auto RBTree<Object, KeyType, ExtractKey, Compare>::
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
 _insertEqual(X&& x) -> Iterator
 {
     Node* parent = nil_;
@@ -362,26 +698,82 @@ _insertEqual(X&& x) -> Iterator
         parent = cur;
         cur = comp(getKey(x), getKey(cur->obj)) ? cur->left : cur->right;
     }
-    Node* node = new Node(std::forward<X>(x));
+    Node* node = createNode(std::forward<X>(x));
     node->left = node->right = nil_;
     node->parent = parent;
     node->color = Color::RED;
 
     if (root_ == nil_)
         root_ = node;
-    else if (comp(getKey(x), getKey(parent->obj)))
+    else if (comp(getKey(node->obj), getKey(parent->obj)))
         parent->left = node;
     else
         parent->right = node;
 
+    setSize(node, 1);
+    addPathSize(parent, 1);
     ++nodeCount_;
     insertRebalance(node);
     return Iterator(node, this);
 }
 
 
-template <class Object, class KeyType, class ExtractKey, class Compare>
-bool  RBTree<Object, KeyType, ExtractKey, Compare>::
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+template <class ForwardIt>
+void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+buildBalanced(ForwardIt first, int n)
+{
+    clear();
+    root_ = buildTree(first, n);
+    nodeCount_ = n;
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+template <class ForwardIt>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+buildTree(ForwardIt first, int n) -> Node*
+{
+    if (n == 0) return nil_;
+    reserveNodes(alloc_, n);
+
+    // 左右子树大小至多相差1，nil节点的深度只有两种取值；
+    // 两者不同时（n+1不是2的幂）把最深一层节点涂红，各路径的黑高相同
+    int height = 0; // 最深节点的深度
+    while ((2 << height) <= n) ++height;
+    int redDepth = ((n + 1) & n) == 0 ? -1 : height;
+
+    Node* root = buildSubtree(first, n, 0, redDepth);
+    root->parent = nil_;
+    root->color = Color::BLACK;
+    return root;
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+template <class ForwardIt>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+buildSubtree(ForwardIt& it, int n, int depth, int redDepth) -> Node*
+{
+    if (n == 0) return nil_;
+    int leftCount = (n - 1) / 2;
+    Node* left = buildSubtree(it, leftCount, depth + 1, redDepth);
+    Node* node = createNode(*it);
+    ++it;
+    Node* right = buildSubtree(it, n - 1 - leftCount, depth + 1, redDepth);
+
+    node->color = depth == redDepth ? Color::RED : Color::BLACK;
+    node->left = left;
+    node->right = right;
+    if (left != nil_) left->parent = node;
+    if (right != nil_) right->parent = node;
+    updateSize(node);
+    return node;
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+bool  RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
 remove(const KeyType& key)
 {
     Node* node = find(key).node;
@@ -394,6 +786,7 @@ remove(const KeyType& key)
         new (&node->obj) Object(std::move(sub->obj));
         node = sub;
     }
+    addPathSize(node->parent, -1); // node为实际删除的节点
     if (node->left == nil_ && node->right == nil_)
     {
         setParentPtr(node, nil_);
@@ -405,14 +798,354 @@ remove(const KeyType& key)
         setParentPtr(node, child);
         child->color = Color::BLACK;
     }
-    delete node;
+    destroyNode(node);
     --nodeCount_;
     return true;
 }
 
 
-template <class Object, class KeyType, class ExtractKey, class Compare>
-void  RBTree<Object, KeyType, ExtractKey, Compare>::
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+int RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+_rank(const KeyType& key, bool inclusive) const
+{
+    static_assert(OrderStatistic::value, "rank requires OrderStatistic");
+    int rank = 0;
+    const Node* cur = root_;
+    while (cur != nil_)
+    {
+        bool before = inclusive ? !comp(key, getKey(cur->obj)) : comp(getKey(cur->obj), key);
+        if (before) // cur及其左子树都计入
+        {
+            rank += cur->left->size + 1;
+            cur = cur->right;
+        }
+        else
+        {
+            cur = cur->left;
+        }
+    }
+    return rank;
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+_select(int i) const -> const Node*
+{
+    static_assert(OrderStatistic::value, "select requires OrderStatistic");
+    if (i < 0 || i >= nodeCount_) return nil_;
+    const Node* cur = root_;
+    while (true)
+    {
+        int leftSize = cur->left->size;
+        if (i < leftSize)
+        {
+            cur = cur->left;
+        }
+        else if (i == leftSize)
+        {
+            return cur;
+        }
+        else
+        {
+            i -= leftSize + 1;
+            cur = cur->right;
+        }
+    }
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+constexpr int RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::kParallelCutoff;
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+joinNodes(Node* left, Node* mid, Node* right) -> Node*
+{
+    // 两侧的根涂黑（nil_本身为黑色，不会被写入）
+    if (left->color == Color::RED) left->color = Color::BLACK;
+    if (right->color == Color::RED) right->color = Color::BLACK;
+    int leftHeight = blackHeight(left);
+    int rightHeight = blackHeight(right);
+    if (leftHeight > rightHeight)
+    {
+        Node* root = joinRight(left, leftHeight, mid, right, rightHeight);
+        if (root->color == Color::RED && root->right->color == Color::RED) root->color = Color::BLACK;
+        return root;
+    }
+    if (leftHeight < rightHeight)
+    {
+        Node* root = joinLeft(left, leftHeight, mid, right, rightHeight);
+        if (root->color == Color::RED && root->left->color == Color::RED) root->color = Color::BLACK;
+        return root;
+    }
+    return attach(mid, left, right, Color::RED);
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+joinRight(Node* left, int height, Node* mid, Node* right, int rightHeight) -> Node*
+{
+    if (left->color == Color::BLACK && height == rightHeight)
+        return attach(mid, left, right, Color::RED);
+
+    bool black = left->color == Color::BLACK;
+    Node* rchild = joinRight(left->right, black ? height - 1 : height, mid, right, rightHeight);
+    attach(left, left->left, rchild, left->color);
+    // 黑色节点下出现连续两个红色右子，左旋并把最下方的红色节点涂黑
+    if (black && rchild->color == Color::RED && rchild->right->color == Color::RED)
+    {
+        rchild->right->color = Color::BLACK;
+        return rotateLeft(left);
+    }
+    return left;
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+joinLeft(Node* left, int leftHeight, Node* mid, Node* right, int height) -> Node*
+{
+    if (right->color == Color::BLACK && height == leftHeight)
+        return attach(mid, left, right, Color::RED);
+
+    bool black = right->color == Color::BLACK;
+    Node* lchild = joinLeft(left, leftHeight, mid, right->left, black ? height - 1 : height);
+    attach(right, lchild, right->right, right->color);
+    if (black && lchild->color == Color::RED && lchild->left->color == Color::RED)
+    {
+        lchild->left->color = Color::BLACK;
+        return rotateRight(right);
+    }
+    return right;
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+concat(Node* left, Node* right) -> Node*
+{
+    if (left == nil_) return right;
+    Node* last;
+    Node* rest = splitLast(left, last);
+    return joinNodes(rest, last, right);
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+splitLast(Node* node, Node*& last) -> Node*
+{
+    if (node->right == nil_)
+    {
+        last = node;
+        return node->left;
+    }
+    Node* rest = splitLast(node->right, last);
+    return joinNodes(node->left, node, rest);
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+splitNode(Node* node, const KeyType& key) -> SplitResult
+{
+    if (node == nil_) return {nil_, nil_, nil_};
+    Node* left = node->left;
+    Node* right = node->right;
+    if (comp(key, getKey(node->obj)))
+    {
+        SplitResult result = splitNode(left, key);
+        result.right = joinNodes(result.right, node, right);
+        return result;
+    }
+    if (comp(getKey(node->obj), key))
+    {
+        SplitResult result = splitNode(right, key);
+        result.left = joinNodes(left, node, result.left);
+        return result;
+    }
+    return {left, node, right};
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+unionNodes(Node* t1, Node* t2, std::vector<Node*>& garbage, int n, int threads) -> Node*
+{
+    if (t1 == nil_) return t2;
+    if (t2 == nil_) return t1;
+    Node* left2 = t2->left;
+    Node* right2 = t2->right;
+    SplitResult split = splitNode(t1, getKey(t2->obj));
+    Node* mid = t2;
+    if (split.middle != nil_) // 重复的元素保留本树的
+    {
+        garbage.push_back(t2);
+        mid = split.middle;
+    }
+    Node* left;
+    Node* right;
+    forkJoin(n, threads, garbage,
+             [&](std::vector<Node*>& g, int t) { left = unionNodes(split.left, left2, g, n / 2, t); },
+             [&](std::vector<Node*>& g, int t) { right = unionNodes(split.right, right2, g, n / 2, t); });
+    return joinNodes(left, mid, right);
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+intersectNodes(Node* t1, const RBTree& rhs, const Node* t2,
+               std::vector<Node*>& garbage, int n, int threads) -> Node*
+{
+    if (t1 == nil_) return nil_;
+    if (t2 == rhs.nil_)
+    {
+        collect(t1, garbage);
+        return nil_;
+    }
+    SplitResult split = splitNode(t1, getKey(t2->obj));
+    Node* left;
+    Node* right;
+    forkJoin(n, threads, garbage,
+             [&](std::vector<Node*>& g, int t)
+             { left = intersectNodes(split.left, rhs, t2->left, g, n / 2, t); },
+             [&](std::vector<Node*>& g, int t)
+             { right = intersectNodes(split.right, rhs, t2->right, g, n / 2, t); });
+    if (split.middle != nil_) return joinNodes(left, split.middle, right);
+    return concat(left, right);
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+auto RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+differenceNodes(Node* t1, const RBTree& rhs, const Node* t2,
+                std::vector<Node*>& garbage, int n, int threads) -> Node*
+{
+    if (t1 == nil_) return nil_;
+    if (t2 == rhs.nil_) return t1;
+    SplitResult split = splitNode(t1, getKey(t2->obj));
+    if (split.middle != nil_) garbage.push_back(split.middle);
+    Node* left;
+    Node* right;
+    forkJoin(n, threads, garbage,
+             [&](std::vector<Node*>& g, int t)
+             { left = differenceNodes(split.left, rhs, t2->left, g, n / 2, t); },
+             [&](std::vector<Node*>& g, int t)
+             { right = differenceNodes(split.right, rhs, t2->right, g, n / 2, t); });
+    return concat(left, right);
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+unionWith(const RBTree& rhs, int threadCount)
+{
+    if (&rhs == this || rhs.nodeCount_ == 0) return;
+    // 先把rhs复制为本树的节点，之后的运算只移动节点、不再分配内存
+    Node* copy = buildTree(rhs.begin(), rhs.nodeCount_);
+    nodeCount_ += rhs.nodeCount_;
+    std::vector<Node*> garbage;
+    Node* root = unionNodes(root_, copy, garbage, nodeCount_, threadCount);
+    finishSetOperation(root, garbage);
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+intersectWith(const RBTree& rhs, int threadCount)
+{
+    if (&rhs == this) return;
+    std::vector<Node*> garbage;
+    Node* root = intersectNodes(root_, rhs, rhs.root_, garbage, nodeCount_ + rhs.nodeCount_, threadCount);
+    finishSetOperation(root, garbage);
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+differenceWith(const RBTree& rhs, int threadCount)
+{
+    if (&rhs == this)
+    {
+        clear();
+        return;
+    }
+    std::vector<Node*> garbage;
+    Node* root = differenceNodes(root_, rhs, rhs.root_, garbage, nodeCount_ + rhs.nodeCount_, threadCount);
+    finishSetOperation(root, garbage);
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+join(RBTree& rhs)
+{
+    static_assert(NodeAllocTraits::is_always_equal::value,
+                  "join requires an allocator that can free nodes of another tree");
+    if (&rhs == this) return;
+    // 节点较少的一侧改挂到另一侧的哨兵上
+    if (nodeCount_ <= rhs.nodeCount_)
+    {
+        relink(root_, nil_, rhs.nil_);
+        std::swap(nil_, rhs.nil_);
+    }
+    else
+    {
+        relink(rhs.root_, rhs.nil_, nil_);
+    }
+    Node* root = concat(root_, rhs.root_);
+    root_ = root;
+    root_->parent = nil_;
+    root_->color = Color::BLACK;
+    nodeCount_ += rhs.nodeCount_;
+    rhs.root_ = rhs.nil_;
+    rhs.nodeCount_ = 0;
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
+split(const KeyType& key, RBTree& right)
+{
+    static_assert(NodeAllocTraits::is_always_equal::value,
+                  "split requires an allocator that can free nodes of another tree");
+    if (&right == this) return;
+    right.clear();
+    SplitResult result = splitNode(root_, key);
+    Node* left = result.left;
+    if (result.middle != nil_) left = joinNodes(left, result.middle, nil_);
+
+    int moved = relink(result.right, nil_, right.nil_);
+    right.root_ = result.right;
+    right.root_->parent = right.nil_;
+    right.root_->color = Color::BLACK;
+    right.nodeCount_ = moved;
+
+    root_ = left;
+    root_->parent = nil_;
+    root_->color = Color::BLACK;
+    nodeCount_ -= moved;
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::clear()
+{
+    // 分配器支持整体释放时只需析构元素，元素可平凡析构时连遍历都可省去
+    const bool bulk = HasBulkRelease<NodeAlloc>::value;
+    if (!bulk || !std::is_trivially_destructible<Object>::value)
+        destroy(root_, bulk);
+    bulkRelease(alloc_);
+    root_ = nil_;
+    nodeCount_ = 0;
+}
+
+
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+void  RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
 insertRebalance(Node* cur)
 {
     while (cur->parent->color == Color::RED)
@@ -466,8 +1199,8 @@ insertRebalance(Node* cur)
 }
 
 
-template <class Object, class KeyType, class ExtractKey, class Compare>
-void RBTree<Object, KeyType, ExtractKey, Compare>::
+template <class Object, class KeyType, class ExtractKey, class Compare, class Alloc, class OrderStatistic>
+void RBTree<Object, KeyType, ExtractKey, Compare, Alloc, OrderStatistic>::
 removeRebalance(Node* cur)
 {
     while (cur != root_)
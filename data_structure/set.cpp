@@ -2,11 +2,14 @@
 #include "rb_tree.hpp"
 
 // 基于红黑树的有序集合
-template <class Object, class Compare = std::less<Object>>
+// OrderStatistic：为std::true_type时支持rank/select/countRange
+template <class Object, class Compare = std::less<Object>,
+          class OrderStatistic = std::false_type>
 class Set
 {
 public:
-    using Tree = RBTree<Object, Object, std::_Identity<Object>, Compare>;
+    using Tree = RBTree<Object, Object, std::_Identity<Object>, Compare,
+                        std::allocator<Object>, OrderStatistic>;
     using Iterator = typename Tree::Iterator;
     using ConstIterator = typename Tree::ConstIterator;
     using KeyType = typename Tree::KeyType;
@@ -22,13 +25,67 @@ public:
     Iterator find(const KeyType& key) {return tree_.find(key);}
     ConstIterator find(const KeyType& key) const {return tree_.find(key);}
 
+    // 第一个不小于/大于key的元素
+    Iterator lowerBound(const KeyType& key) { return tree_.lowerBound(key); }
+    ConstIterator lowerBound(const KeyType& key) const { return tree_.lowerBound(key); }
+
+    Iterator upperBound(const KeyType& key) { return tree_.upperBound(key); }
+    ConstIterator upperBound(const KeyType& key) const { return tree_.upperBound(key); }
+
+    std::pair<Iterator, Iterator> equalRange(const KeyType& key)
+    { return tree_.equalRange(key); }
+
+    std::pair<ConstIterator, ConstIterator> equalRange(const KeyType& key) const
+    { return tree_.equalRange(key); }
+
+    // 按顺序遍历key在[lo, hi]内的元素
+    template <class Fn>
+    void forEachInRange(const KeyType& lo, const KeyType& hi, Fn fn)
+    { tree_.forEachInRange(lo, hi, fn); }
+
+    template <class Fn>
+    void forEachInRange(const KeyType& lo, const KeyType& hi, Fn fn) const
+    { tree_.forEachInRange(lo, hi, fn); }
+
+    // 由有序区间[first, last)线性时间构建，原有元素被清空
+    template <class ForwardIt>
+    void buildFromSorted(ForwardIt first, ForwardIt last)
+    { tree_.buildFromSorted(first, last); }
+
     // 删除
     bool remove(const KeyType& key) { return tree_.remove(key); }
 
+    // 并、交、差，threadCount > 1时较大的子问题并行计算
+    void unionWith(const Set& rhs, int threadCount = 1)
+    { tree_.unionWith(rhs.tree_, threadCount); }
+
+    void intersectWith(const Set& rhs, int threadCount = 1)
+    { tree_.intersectWith(rhs.tree_, threadCount); }
+
+    void differenceWith(const Set& rhs, int threadCount = 1)
+    { tree_.differenceWith(rhs.tree_, threadCount); }
+
+    // 把rhs拼接到末尾，rhs的元素须都大于本集合的元素
+    void join(Set& rhs) { tree_.join(rhs.tree_); }
+
+    // 大于key的元素移入right
+    void split(const KeyType& key, Set& right) { tree_.split(key, right.tree_); }
+
     void clear() { tree_.clear(); }
 
     int size() const { return tree_.size(); }
 
+    // 小于key的元素个数
+    int rank(const KeyType& key) const { return tree_.rank(key); }
+
+    // 第i小的元素（从0开始）
+    Iterator select(int i) { return tree_.select(i); }
+    ConstIterator select(int i) const { return tree_.select(i); }
+
+    // key在[lo, hi]内的元素个数
+    int countRange(const KeyType& lo, const KeyType& hi) const
+    { return tree_.countRange(lo, hi); }
+
     ConstIterator begin() const { return tree_.begin(); }
     Iterator begin() { return tree_.begin(); }
 
@@ -41,7 +98,9 @@ private:
 
 
 // 测试
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 int main()
 {
@@ -63,5 +122,56 @@ int main()
     for (const auto& x : set) cout << x << " ";
     cout << endl;
 
+    // 顺序统计
+    Set<int, less<int>, true_type> ranked;
+    for (int x : {50, 20, 80, 10, 30, 70, 90}) ranked.insert(x);
+    ranked.remove(80);
+    cout << ranked.rank(30) << " " << *ranked.select(4) << " "
+         << ranked.countRange(20, 75) << endl;
+
+    // 范围查询
+    cout << *ranked.lowerBound(25) << " " << *ranked.upperBound(50) << " "
+         << (ranked.lowerBound(95) == ranked.end()) << endl;
+    ranked.forEachInRange(20, 70, [](int x) { cout << x << " "; });
+    cout << endl;
+
+    // 集合运算
+    Set<int> a, b;
+    for (int i = 0; i < 10; ++i) a.insert(i * 2);
+    for (int i = 0; i < 10; ++i) b.insert(i * 3);
+    Set<int> u = a, in = a, diff = a;
+    u.unionWith(b);
+    in.intersectWith(b);
+    diff.differenceWith(b);
+    for (const auto& x : in) cout << x << " ";
+    cout << "| " << u.size() << " " << diff.size() << endl;
+
+    Set<int> high;
+    u.split(10, high);
+    cout << u.size() << " " << high.size() << " ";
+    u.join(high);
+    cout << u.size() << endl;
+
+    // 逐个插入与并运算的耗时对比
+    using namespace std::chrono;
+    const int n = 1 << 20;
+    Set<int> big1, big2;
+    for (int i = 0; i < n; ++i) big1.insert(i * 2);
+    for (int i = 0; i < n; ++i) big2.insert(i * 3);
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto start = steady_clock::now();
+    Set<int> inserted = big1;
+    for (const auto& x : big2) inserted.insert(x);
+    double insertMs = duration<double, milli>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+    Set<int> joined = big1;
+    joined.unionWith(big2, threads);
+    double unionMs = duration<double, milli>(steady_clock::now() - start).count();
+
+    cout << "insert: " << insertMs << " ms, unionWith(" << threads << " threads): "
+         << unionMs << " ms (" << inserted.size() << " " << joined.size() << ")" << endl;
+
     return 0;
 }
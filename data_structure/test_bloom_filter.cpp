@@ -0,0 +1,51 @@
+#include "bloom_filter.hpp"
+#include <iostream>
+#include <iomanip>
+#include <random>
+
+int main()
+{
+    using namespace std;
+    BloomFilter<int> filter(100);
+    for (int i = 0; i < 100; ++i) filter.insert(i);
+    cout << filter.mayContain(42) << " " << filter.mayContain(-1) << endl;
+
+    // 被移动后仍可使用
+    BloomFilter<int> moved = std::move(filter);
+    filter.insert(7);
+    cout << moved.mayContain(42) << " " << filter.mayContain(7) << " "
+         << filter.blockCount() << endl;
+    moved = std::move(filter);
+    filter.insert(8);
+    cout << moved.mayContain(7) << " " << filter.mayContain(8) << endl;
+
+    // 实测误判率与目标误判率、每个key的位数
+    const int n = 1 << 20;
+    mt19937_64 rng(1);
+    cout << fixed << setprecision(4);
+    cout << setw(10) << "target" << setw(12) << "bits/key" << setw(12) << "estimated"
+         << setw(12) << "measured" << endl;
+    for (double fp : {0.1, 0.01, 0.001})
+    {
+        BloomFilter<long> bf(n, fp);
+        for (int i = 0; i < n; ++i) bf.insert(rng() | 1);
+        int falsePositives = 0;
+        for (int i = 0; i < n; ++i) falsePositives += bf.mayContain(rng() & ~1L);
+        cout << setw(10) << fp << setw(12) << bf.bitsPerKey()
+             << setw(12) << bf.estimatedFpRate()
+             << setw(12) << (double)falsePositives / n << endl;
+    }
+
+    // 按每个key的位数构造
+    for (double bits : {8.0, 12.0, 16.0})
+    {
+        auto bf = BloomFilter<long>::withBitsPerKey(n, bits);
+        for (int i = 0; i < n; ++i) bf.insert(rng() | 1);
+        int falsePositives = 0;
+        for (int i = 0; i < n; ++i) falsePositives += bf.mayContain(rng() & ~1L);
+        cout << setw(10) << bf.targetFpRate() << setw(12) << bf.bitsPerKey()
+             << setw(12) << bf.estimatedFpRate()
+             << setw(12) << (double)falsePositives / n << endl;
+    }
+    return 0;
+}
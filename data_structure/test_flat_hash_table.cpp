@@ -0,0 +1,34 @@
+#include "flat_hash_table.hpp"
+#include <iostream>
+#include <vector>
+
+int main()
+{
+    using namespace std;
+    FlatHashTable<int> ht;
+    for (int i = 0; i < 1000; ++i) ht.insert(i);
+    for (int i = 0; i < 1000; i += 3) ht.remove(i);
+    cout << ht.size() << " " << ht.bucketCount() << endl;
+
+    int sum = 0;
+    for (const auto& x : ht) sum += x;
+    cout << sum << endl;
+
+    cout << (ht.find(1) != ht.end()) << endl;
+    cout << (ht.find(3) != ht.end()) << endl;
+
+    FlatHashTable<int> copy = ht;
+    copy.insert(3);
+    cout << copy.size() << " " << ht.size() << endl;
+
+    // 批量构造和插入
+    vector<int> nums;
+    for (int i = 0; i < 5000; ++i) nums.push_back(i % 3000);
+    FlatHashTable<int> bulk(nums.begin(), nums.end());
+    int buckets = bulk.bucketCount();
+    bulk.insertRange(nums.begin(), nums.begin() + 1000);
+    cout << bulk.size() << " " << (bulk.bucketCount() == buckets) << " "
+         << bulk.count(2999, bulk.hashCode(2999)) << endl;
+
+    return 0;
+}
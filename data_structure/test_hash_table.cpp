@@ -1,6 +1,8 @@
 
 #include "hash_table.hpp"
 #include <iostream>
+#include <set>
+#include <string>
 
 int main()
 {
@@ -13,5 +15,60 @@ int main()
     for (const auto& x : ht) cout << x << " ";
     cout << endl;
 
+    // 渐进式rehash
+    HashTable<int> inc(4);
+    inc.setIncrementalRehash(true);
+    for (int i = 0; i < 100; ++i) inc.insert(i);
+    cout << inc.size() << " " << inc.bucketCount() << " " << inc.rehashing() << endl;
+
+    int count = 0;
+    for (auto it = inc.begin(); it != inc.end(); ++it) ++count;
+    cout << count << " " << (inc.find(50) != inc.end()) << endl;
+
+    // 迁移期间边遍历边查找、删除，每个元素恰好访问一次
+    // （先遍历一段，使迭代器进入尚未迁移的旧桶）
+    HashTable<int> mig(4);
+    mig.setIncrementalRehash(true);
+    for (int i = 0; i < 1025; ++i) mig.insert(i);
+    set<int> seen;
+    int visits = 0;
+    bool rehashing = mig.rehashing();
+    for (auto it = mig.begin(); it != mig.end() && visits <= mig.size(); ++it, ++visits)
+    {
+        seen.insert(*it);
+        if (visits < 20) continue;
+        mig.find(*it);
+        mig.remove(-1);
+    }
+    cout << rehashing << " " << visits << " " << seen.size() << " " << mig.size() << endl;
+
+    // 没有迭代时，查找和删除也推进迁移；插入后迭代结束，查找恢复迁移
+    HashTable<int> lookups(4);
+    lookups.setIncrementalRehash(true);
+    for (int i = 0; i < 1025; ++i) lookups.insert(i);
+    rehashing = lookups.rehashing();
+    for (int i = 0; i < 1000; ++i) lookups.find(i);
+    cout << rehashing << " " << lookups.rehashing() << " ";
+    for (int i = 1025; i < 2049; ++i) lookups.insert(i);
+    for (auto it = lookups.begin(); it != lookups.end(); ++it) {}
+    for (int i = 0; i < 1000; ++i) lookups.remove(-1);
+    rehashing = lookups.rehashing();
+    lookups.insert(-2);
+    for (int i = 0; i < 1000; ++i) lookups.remove(-1);
+    cout << rehashing << " " << lookups.rehashing() << endl;
+
+    // 节点缓存哈希值
+    HashTable<string, hash<string>, std::_Identity<string>,
+              allocator<string>, true_type> strs(4);
+    for (int i = 0; i < 100; ++i) strs.insert("key" + to_string(i));
+    strs.remove("key10");
+    cout << strs.size() << " " << (strs.find("key42") != strs.end())
+         << " " << (strs.find("key10") != strs.end()) << endl;
+
+    // 清空后查找、插入
+    strs.clear();
+    cout << strs.size() << " " << (strs.find("key42") != strs.end())
+         << " " << strs.remove("key42") << " " << strs.insert("key42").second << endl;
+
     return 0;
 }
@@ -0,0 +1,39 @@
+#define HASH_TABLE_STATS
+#include "hash_table.hpp"
+#include "linked_hash_table.hpp"
+#include <iostream>
+
+// 只用低4位的差哈希函数
+struct BadHash
+{
+    size_t operator()(int x) const { return x & 15; }
+};
+
+int main()
+{
+    using namespace std;
+    HashTable<int> good;
+    HashTable<int, BadHash> bad;
+    for (int i = 0; i < 1000; ++i)
+    {
+        good.insert(i);
+        bad.insert(i);
+    }
+    for (int i = 0; i < 2000; ++i)
+    {
+        good.find(i);
+        bad.find(i);
+    }
+
+    good.stats().dumpText(cout);
+    cout << endl;
+    bad.stats().dumpJson(cout);
+    cout << endl;
+
+    LinkedHashTable<int> linked;
+    for (int i = 0; i < 100; ++i) linked.insert(i * 64);
+    for (int i = 0; i < 100; ++i) linked.find(i);
+    linked.stats().dumpText(cout);
+
+    return 0;
+}
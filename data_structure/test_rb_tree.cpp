@@ -1,6 +1,7 @@
 
 #include "rb_tree.hpp"
 
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
 #include <vector>
@@ -42,5 +43,40 @@ int main()
         }
         cout << endl;
     }
+
+    // 由有序区间构建
+    vector<int> sorted;
+    for (int i = 0; i < 12; ++i) sorted.push_back(i * 3);
+    tree.buildFromSorted(sorted.begin(), sorted.end());
+    for (const auto& x : tree) cout << setw(3) << x;
+    cout << endl;
+    for (auto it = tree.begin(); it != tree.end(); ++it)
+    {
+        cout << setw(3) << static_cast<int>(it.node->color);
+    }
+    cout << endl;
+
+    // 逐个插入与线性构建的耗时对比
+    using namespace std::chrono;
+    const int n = 1 << 20;
+    sorted.clear();
+    for (int i = 0; i < n; ++i) sorted.push_back(i);
+
+    auto start = steady_clock::now();
+    RBTree<int> inserted;
+    for (int x : sorted) inserted.insert(x);
+    double insertMs = duration<double, milli>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+    RBTree<int> built;
+    built.buildFromSorted(sorted.begin(), sorted.end());
+    double buildMs = duration<double, milli>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+    RBTree<int> copied(built);
+    double copyMs = duration<double, milli>(steady_clock::now() - start).count();
+
+    cout << "insert: " << insertMs << " ms, buildFromSorted: " << buildMs
+         << " ms, copy: " << copyMs << " ms (" << copied.size() << ")" << endl;
     return 0;
 }